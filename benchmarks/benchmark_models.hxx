@@ -0,0 +1,227 @@
+#ifndef LP_MP_BENCHMARK_MODELS_HXX
+#define LP_MP_BENCHMARK_MODELS_HXX
+
+#include <vector>
+#include <array>
+#include <random>
+#include <algorithm>
+#include <bitset>
+#include "config.hxx"
+#include "factors_messages.hxx"
+#include "factors/labeling_list_factor.hxx"
+#include "two_dimensional_variable_array.hxx"
+#include "locality_ordering.hxx"
+
+namespace LP_MP {
+
+// synthetic binary pairwise models built from labeling factors/messages for timing message passing.
+// Unaries hold the cost of label 1, pairwise factors the costs of labelings (0,1), (1,0), (1,1). Labeling 0 resp. (0,0) is the implicit origin with cost 0.
+using benchmark_unary_labelings = labelings< labeling<1> >;
+using benchmark_pairwise_labelings = labelings< labeling<0,1>, labeling<1,0>, labeling<1,1> >;
+
+struct benchmark_FMC {
+   constexpr static const char* name = "binary pairwise benchmark model";
+   using unary_factor = FactorContainer<labeling_factor<benchmark_unary_labelings, true>, benchmark_FMC, 0, false>;
+   using pairwise_factor = FactorContainer<labeling_factor<benchmark_pairwise_labelings, true>, benchmark_FMC, 1, false>;
+   using unary_pairwise_message_0 = MessageContainer<labeling_message<benchmark_unary_labelings, benchmark_pairwise_labelings, 0>, 0, 1, message_passing_schedule::left, variableMessageNumber, 1, benchmark_FMC, 0>;
+   using unary_pairwise_message_1 = MessageContainer<labeling_message<benchmark_unary_labelings, benchmark_pairwise_labelings, 1>, 0, 1, message_passing_schedule::left, variableMessageNumber, 1, benchmark_FMC, 1>;
+
+   using FactorList = meta::list<unary_factor, pairwise_factor>;
+   using MessageList = meta::list<unary_pairwise_message_0, unary_pairwise_message_1>;
+   using ProblemDecompositionList = meta::list<>;
+};
+
+// labeling factor with implicit origin whose costs are held in a vector allocated from the block arena, like factors of variable size, instead of inside the factor container.
+// Only such dual memory is moved by LP::relocate_factors.
+template<typename LABELINGS>
+class benchmark_arena_labeling_factor : public vector<REAL>
+{
+public:
+   benchmark_arena_labeling_factor()
+      : vector<REAL>(LABELINGS::no_labelings(), 0.0)
+   {}
+
+   constexpr static bool has_implicit_origin() { return true; }
+   constexpr static INDEX size() { return LABELINGS::no_labelings(); }
+   constexpr static INDEX primal_size() { return LABELINGS::no_labels(); }
+
+   REAL LowerBound() const { return std::min(REAL(0.0), this->min()); }
+
+   REAL EvaluatePrimal() const
+   {
+      const INDEX labeling_no = LABELINGS::matching_labeling(primal_);
+      if(labeling_no < size()) {
+         return (*this)[labeling_no];
+      }
+      if(primal_.count() == 0) {
+         return 0.0;
+      }
+      return std::numeric_limits<REAL>::infinity();
+   }
+
+   auto& primal() { return primal_; }
+   const auto& primal() const { return primal_; }
+
+   void init_primal() {}
+   template<typename ARCHIVE> void serialize_dual(ARCHIVE& ar) { ar( binary_data<REAL>(&(*this)[0], size()) ); }
+   template<typename ARCHIVE> void serialize_primal(ARCHIVE& ar) { ar( primal_ ); }
+
+   auto export_variables() { return std::tie( *static_cast<vector<REAL>*>(this) ); }
+
+   template<typename EXTERNAL_SOLVER, typename VECTOR>
+   void construct_constraints(EXTERNAL_SOLVER& s, VECTOR vars) const
+   {
+      s.add_at_most_one_constraint(vars.begin(), vars.end());
+   }
+
+   template<typename EXTERNAL_SOLVER, typename VECTOR>
+   void convert_primal(EXTERNAL_SOLVER& s, VECTOR vars)
+   {
+      primal_.reset();
+      primal_ = s.first_active(vars.begin(), vars.end());
+   }
+
+private:
+   std::bitset<primal_size()> primal_;
+};
+
+// same model as benchmark_FMC with factor costs in the block arena
+struct benchmark_arena_FMC {
+   constexpr static const char* name = "binary pairwise benchmark model with factor costs in block arena";
+   using unary_factor = FactorContainer<benchmark_arena_labeling_factor<benchmark_unary_labelings>, benchmark_arena_FMC, 0, false>;
+   using pairwise_factor = FactorContainer<benchmark_arena_labeling_factor<benchmark_pairwise_labelings>, benchmark_arena_FMC, 1, false>;
+   using unary_pairwise_message_0 = MessageContainer<labeling_message<benchmark_unary_labelings, benchmark_pairwise_labelings, 0>, 0, 1, message_passing_schedule::left, variableMessageNumber, 1, benchmark_arena_FMC, 0>;
+   using unary_pairwise_message_1 = MessageContainer<labeling_message<benchmark_unary_labelings, benchmark_pairwise_labelings, 1>, 0, 1, message_passing_schedule::left, variableMessageNumber, 1, benchmark_arena_FMC, 1>;
+
+   using FactorList = meta::list<unary_factor, pairwise_factor>;
+   using MessageList = meta::list<unary_pairwise_message_0, unary_pairwise_message_1>;
+   using ProblemDecompositionList = meta::list<>;
+};
+
+enum class benchmark_model_type {grid, random_sparse, chain};
+
+inline std::string to_string(const benchmark_model_type t)
+{
+   switch(t) {
+      case benchmark_model_type::grid: return "grid";
+      case benchmark_model_type::random_sparse: return "random_sparse";
+      case benchmark_model_type::chain: return "chain";
+   }
+   return "";
+}
+
+// edges (i,j) with i<j. Grid has size x size nodes, random sparse graph has size nodes and average degree 4, chain has size nodes.
+inline std::vector<std::array<INDEX,2>> benchmark_model_edges(const benchmark_model_type t, const INDEX size, std::mt19937& gen)
+{
+   std::vector<std::array<INDEX,2>> edges;
+   if(t == benchmark_model_type::grid) {
+      for(INDEX x=0; x<size; ++x) {
+         for(INDEX y=0; y<size; ++y) {
+            if(x+1 < size) { edges.push_back({x*size + y, (x+1)*size + y}); }
+            if(y+1 < size) { edges.push_back({x*size + y, x*size + y+1}); }
+         }
+      }
+   } else if(t == benchmark_model_type::random_sparse) {
+      std::uniform_int_distribution<INDEX> node_dist(0, size-1);
+      for(INDEX e=0; e<2*size; ++e) {
+         const INDEX i = node_dist(gen);
+         const INDEX j = node_dist(gen);
+         if(i != j) { edges.push_back({std::min(i,j), std::max(i,j)}); }
+      }
+      std::sort(edges.begin(), edges.end());
+      edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+   } else {
+      assert(t == benchmark_model_type::chain);
+      for(INDEX i=0; i+1<size; ++i) { edges.push_back({i,i+1}); }
+   }
+   return edges;
+}
+
+// order in which unaries are added and hence laid out in memory: as numbered, randomly or in reverse Cuthill-McKee order of the model graph.
+// Pairwise factors follow in the order of their first unary.
+enum class benchmark_node_order {natural, shuffled, rcm};
+
+inline std::string to_string(const benchmark_node_order o)
+{
+   switch(o) {
+      case benchmark_node_order::natural: return "natural";
+      case benchmark_node_order::shuffled: return "shuffled";
+      case benchmark_node_order::rcm: return "rcm";
+   }
+   return "";
+}
+
+inline INDEX benchmark_model_no_nodes(const benchmark_model_type t, const INDEX size)
+{
+   return t == benchmark_model_type::grid ? size*size : size;
+}
+
+// positions of nodes in the order they are added
+inline std::vector<INDEX> benchmark_node_positions(const INDEX no_nodes, const std::vector<std::array<INDEX,2>>& edges, const benchmark_node_order o, std::mt19937& gen)
+{
+   std::vector<INDEX> order(no_nodes);
+   for(INDEX i=0; i<no_nodes; ++i) { order[i] = i; }
+   if(o == benchmark_node_order::shuffled) {
+      std::shuffle(order.begin(), order.end(), gen);
+   } else if(o == benchmark_node_order::rcm) {
+      std::vector<INDEX> degree(no_nodes, 0);
+      for(const auto& e : edges) { ++degree[e[0]]; ++degree[e[1]]; }
+      two_dim_variable_array<INDEX> adjacency(degree);
+      std::fill(degree.begin(), degree.end(), 0);
+      for(const auto& e : edges) {
+         adjacency(e[0], degree[e[0]]++) = e[1];
+         adjacency(e[1], degree[e[1]]++) = e[0];
+      }
+      order = reverse_cuthill_mckee(adjacency);
+   }
+   std::vector<INDEX> position(no_nodes);
+   for(INDEX k=0; k<no_nodes; ++k) { position[order[k]] = k; }
+   return position;
+}
+
+template<typename LP_TYPE>
+void build_benchmark_model(LP_TYPE& lp, const benchmark_model_type t, const INDEX size, const unsigned int seed = 0, const benchmark_node_order node_order = benchmark_node_order::natural)
+{
+   std::mt19937 gen(seed);
+   std::uniform_real_distribution<REAL> cost_dist(-1.0, 1.0);
+
+   const INDEX no_nodes = benchmark_model_no_nodes(t, size);
+   std::vector<REAL> unary_cost(no_nodes);
+   for(auto& c : unary_cost) { c = cost_dist(gen); }
+   const auto edges = benchmark_model_edges(t, size, gen);
+   std::vector<std::array<REAL,3>> pairwise_cost(edges.size());
+   for(auto& c : pairwise_cost) { for(auto& x : c) { x = cost_dist(gen); } }
+
+   // the model does not depend on the node order, only the order of adding factors does
+   std::vector<INDEX> node_sequence(no_nodes), edge_sequence(edges.size());
+   for(INDEX i=0; i<no_nodes; ++i) { node_sequence[i] = i; }
+   for(INDEX e=0; e<edges.size(); ++e) { edge_sequence[e] = e; }
+   if(node_order != benchmark_node_order::natural) {
+      std::mt19937 order_gen(seed);
+      const auto position = benchmark_node_positions(no_nodes, edges, node_order, order_gen);
+      for(INDEX i=0; i<no_nodes; ++i) { node_sequence[position[i]] = i; }
+      auto first_position = [&](const INDEX e) { return std::min(position[edges[e][0]], position[edges[e][1]]); };
+      std::stable_sort(edge_sequence.begin(), edge_sequence.end(), [&](const INDEX e1, const INDEX e2) { return first_position(e1) < first_position(e2); });
+   }
+
+   using FMC = typename LP_TYPE::FMC;
+   std::vector<typename FMC::unary_factor*> unaries(no_nodes);
+   for(const INDEX i : node_sequence) {
+      auto* u = lp.template add_factor<typename FMC::unary_factor>();
+      (*u->GetFactor())[0] = unary_cost[i];
+      unaries[i] = u;
+   }
+
+   for(const INDEX e : edge_sequence) {
+      auto* p = lp.template add_factor<typename FMC::pairwise_factor>();
+      for(INDEX k=0; k<3; ++k) { (*p->GetFactor())[k] = pairwise_cost[e][k]; }
+      lp.template add_message<typename FMC::unary_pairwise_message_0>(unaries[edges[e][0]], p);
+      lp.template add_message<typename FMC::unary_pairwise_message_1>(unaries[edges[e][1]], p);
+      lp.AddFactorRelation(unaries[edges[e][0]], p);
+      lp.AddFactorRelation(p, unaries[edges[e][1]]);
+   }
+}
+
+} // end namespace LP_MP
+
+#endif // LP_MP_BENCHMARK_MODELS_HXX
@@ -0,0 +1,222 @@
+#include "LP_MP.h"
+#include "benchmark_models.hxx"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace LP_MP;
+
+// compares message passing on the same synthetic models with factors added in different orders, which determines their placement in memory.
+// Models whose factor costs lie in the block arena are additionally run with --relocateFactors none|update|rcm, which moves these costs but not the factor containers.
+// Reports pass times, hardware cache misses where the kernel permits counting them, and how far apart the costs of consecutively updated factors are in memory.
+// usage: locality_benchmark [--size <n>] [--repetitions <n>] [--output <file>]
+
+// counts cache misses of the calling thread. Counting is disabled if perf events are not available, e.g. in containers.
+class cache_miss_counter {
+public:
+   cache_miss_counter(const std::uint64_t config, const std::uint32_t type)
+   {
+#ifdef __linux__
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = type;
+      attr.config = config;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      fd_ = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+   }
+   ~cache_miss_counter()
+   {
+#ifdef __linux__
+      if(fd_ >= 0) { close(fd_); }
+#endif
+   }
+   cache_miss_counter(const cache_miss_counter&) = delete;
+   cache_miss_counter& operator=(const cache_miss_counter&) = delete;
+
+   bool available() const { return fd_ >= 0; }
+
+   void start()
+   {
+#ifdef __linux__
+      if(available()) {
+         ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+         ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+      }
+#endif
+   }
+   // number of misses since start
+   std::uint64_t stop()
+   {
+      std::uint64_t count = 0;
+#ifdef __linux__
+      if(available()) {
+         ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+         if(read(fd_, &count, sizeof(count)) != sizeof(count)) { count = 0; }
+      }
+#endif
+      return count;
+   }
+
+private:
+   int fd_ = -1;
+};
+
+#ifdef __linux__
+constexpr std::uint64_t l1d_read_miss_config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+#endif
+
+struct locality_result {
+   std::string model;
+   std::string factor_costs; // container or arena
+   std::string node_order;
+   std::string relocation;
+   INDEX no_factors;
+   double mean_address_gap; // in cache lines between costs of consecutively updated factors
+   double same_page_fraction; // fraction of consecutive updates whose factor costs lie within one page
+   std::vector<double> pass_times; // forward and backward pass, seconds per repetition
+   std::vector<std::uint64_t> l1d_misses, llc_misses; // per repetition, empty if not available
+};
+
+// address of the factor's costs: inside the container for benchmark_FMC, in the block arena for benchmark_arena_FMC
+template<typename FMC>
+std::uintptr_t factor_cost_address(FactorTypeAdapter* f)
+{
+   if(auto* u = dynamic_cast<typename FMC::unary_factor*>(f)) {
+      return reinterpret_cast<std::uintptr_t>(&(*u->GetFactor())[0]);
+   }
+   auto* p = dynamic_cast<typename FMC::pairwise_factor*>(f);
+   assert(p != nullptr);
+   return reinterpret_cast<std::uintptr_t>(&(*p->GetFactor())[0]);
+}
+
+template<typename FMC>
+void factor_address_gaps(LP<FMC>& lp, locality_result& r)
+{
+   constexpr std::uintptr_t cache_line = 64;
+   constexpr std::uintptr_t page = 4096;
+   const auto& ordering = lp.forward_update_ordering();
+   double gap_sum = 0.0;
+   INDEX same_page = 0;
+   for(INDEX i=1; i<ordering.size(); ++i) {
+      const std::uintptr_t a = factor_cost_address<FMC>(ordering[i-1]);
+      const std::uintptr_t b = factor_cost_address<FMC>(ordering[i]);
+      const std::uintptr_t gap = a > b ? a - b : b - a;
+      gap_sum += double(gap/cache_line);
+      if(a/page == b/page) { ++same_page; }
+   }
+   const INDEX n = std::max(INDEX(1), INDEX(ordering.size()) - 1);
+   r.mean_address_gap = gap_sum / n;
+   r.same_page_fraction = double(same_page) / n;
+}
+
+template<typename FMC>
+locality_result run_benchmark(const benchmark_model_type t, const benchmark_node_order o, const std::string& relocation, const INDEX size, const INDEX repetitions)
+{
+   TCLAP::CmdLine cmd("", ' ', "");
+   LP<FMC> lp(cmd);
+   std::vector<std::string> options = {"locality_benchmark", "--relocateFactors", relocation};
+   cmd.parse(options);
+
+   build_benchmark_model(lp, t, size, 0, o);
+   lp.Begin(); // relocates factor costs
+   lp.set_reparametrization(LPReparametrizationMode::Anisotropic);
+   lp.ComputePass(0); // sorts factors and computes weights, not timed
+
+   const std::string factor_costs = std::is_same<FMC, benchmark_arena_FMC>::value ? "arena" : "container";
+   locality_result r{to_string(t), factor_costs, to_string(o), relocation, lp.GetNumberOfFactors(), 0.0, 0.0, {}, {}, {}};
+   factor_address_gaps(lp, r);
+
+#ifdef __linux__
+   cache_miss_counter l1d(l1d_read_miss_config, PERF_TYPE_HW_CACHE);
+   cache_miss_counter llc(PERF_COUNT_HW_CACHE_MISSES, PERF_TYPE_HARDWARE);
+#else
+   cache_miss_counter l1d(0,0);
+   cache_miss_counter llc(0,0);
+#endif
+   for(INDEX rep=0; rep<repetitions; ++rep) {
+      l1d.start();
+      llc.start();
+      const auto begin = std::chrono::steady_clock::now();
+      lp.ComputeForwardPass();
+      lp.ComputeBackwardPass();
+      r.pass_times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+      const auto l1d_misses = l1d.stop();
+      const auto llc_misses = llc.stop();
+      if(l1d.available()) { r.l1d_misses.push_back(l1d_misses); }
+      if(llc.available()) { r.llc_misses.push_back(llc_misses); }
+   }
+   if(!std::isfinite(lp.LowerBound())) { throw std::runtime_error("lower bound not finite"); }
+   return r;
+}
+
+template<typename T>
+void write_statistics(std::stringstream& s, const std::vector<T>& v)
+{
+   if(v.empty()) { s << "null"; return; }
+   const double min = *std::min_element(v.begin(), v.end());
+   const double mean = std::accumulate(v.begin(), v.end(), 0.0) / v.size();
+   s << "{\"min\": " << min << ", \"mean\": " << mean << ", \"repetitions\": " << v.size() << "}";
+}
+
+std::string to_json(const std::vector<locality_result>& results)
+{
+   std::stringstream s;
+   s << "{\n  \"benchmarks\": [\n";
+   for(INDEX i=0; i<results.size(); ++i) {
+      const auto& r = results[i];
+      s << "    {\"model\": \"" << r.model << "\", \"factor_costs\": \"" << r.factor_costs << "\", \"node_order\": \"" << r.node_order << "\", \"relocation\": \"" << r.relocation << "\", \"factors\": " << r.no_factors
+        << ", \"mean_address_gap_cache_lines\": " << r.mean_address_gap << ", \"same_page_fraction\": " << r.same_page_fraction << ", \"pass_time\": ";
+      write_statistics(s, r.pass_times);
+      s << ", \"l1d_read_misses\": ";
+      write_statistics(s, r.l1d_misses);
+      s << ", \"llc_misses\": ";
+      write_statistics(s, r.llc_misses);
+      s << "}" << (i+1 < results.size() ? "," : "") << "\n";
+   }
+   s << "  ]\n}\n";
+   return s.str();
+}
+
+int main(int argc, char** argv)
+{
+   TCLAP::CmdLine cmd("factor memory locality benchmark", ' ', "0.1");
+   TCLAP::ValueArg<INDEX> size_arg("","size","size of synthetic models: side length of grid, number of nodes otherwise",false,300,&positiveIntegerConstraint,cmd);
+   TCLAP::ValueArg<INDEX> repetitions_arg("","repetitions","number of timed repetitions of a forward and backward pass",false,10,&positiveIntegerConstraint,cmd);
+   TCLAP::ValueArg<std::string> output_arg("o","output","file to write JSON results to, default: standard output",false,"","file name",cmd);
+   cmd.parse(argc, argv);
+
+   const INDEX n = size_arg.getValue();
+   std::vector<locality_result> results;
+   for(const auto o : {benchmark_node_order::natural, benchmark_node_order::shuffled, benchmark_node_order::rcm}) {
+      results.push_back(run_benchmark<benchmark_FMC>(benchmark_model_type::grid, o, "none", n, repetitions_arg.getValue()));
+      results.push_back(run_benchmark<benchmark_FMC>(benchmark_model_type::random_sparse, o, "none", n*n, repetitions_arg.getValue()));
+   }
+   // relocation can only repair the placement of costs, the factor containers stay in the order they were added
+   for(const auto o : {benchmark_node_order::natural, benchmark_node_order::shuffled}) {
+      for(const std::string relocation : {"none", "update", "rcm"}) {
+         results.push_back(run_benchmark<benchmark_arena_FMC>(benchmark_model_type::grid, o, relocation, n, repetitions_arg.getValue()));
+         results.push_back(run_benchmark<benchmark_arena_FMC>(benchmark_model_type::random_sparse, o, relocation, n*n, repetitions_arg.getValue()));
+      }
+   }
+
+   const std::string json = to_json(results);
+   if(output_arg.getValue() != "") {
+      std::ofstream f(output_arg.getValue());
+      f << json;
+   } else {
+      std::cout << json;
+   }
+}
@@ -0,0 +1,96 @@
+#include "LP_MP.h"
+#include "benchmark_models.hxx"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+using namespace LP_MP;
+
+// times single parts of message passing on synthetic models and writes the results as JSON.
+// usage: message_passing_benchmark [--size <n>] [--repetitions <n>] [--output <file>]
+
+struct benchmark_result {
+   std::string model;
+   INDEX size;
+   INDEX no_factors;
+   INDEX no_messages;
+   std::vector<std::pair<std::string, std::vector<double>>> timings; // seconds per repetition
+};
+
+template<typename FUNC>
+std::vector<double> time_repetitions(const INDEX repetitions, FUNC f)
+{
+   std::vector<double> t;
+   t.reserve(repetitions);
+   for(INDEX r=0; r<repetitions; ++r) {
+      const auto begin = std::chrono::steady_clock::now();
+      f();
+      t.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+   }
+   return t;
+}
+
+benchmark_result run_benchmark(const benchmark_model_type t, const INDEX size, const INDEX repetitions)
+{
+   TCLAP::CmdLine cmd("", ' ', "");
+   LP<benchmark_FMC> lp(cmd);
+   std::vector<std::string> options = {"message_passing_benchmark"};
+   cmd.parse(options);
+
+   build_benchmark_model(lp, t, size);
+   lp.Begin();
+   lp.set_reparametrization(LPReparametrizationMode::Anisotropic);
+   lp.ComputePass(0); // sorts factors and computes weights, not timed
+
+   benchmark_result r{to_string(t), size, lp.GetNumberOfFactors(), lp.GetNumberOfMessages(), {}};
+   r.timings.push_back({"ComputeForwardPass", time_repetitions(repetitions, [&]() { lp.ComputeForwardPass(); })});
+   r.timings.push_back({"ComputeBackwardPass", time_repetitions(repetitions, [&]() { lp.ComputeBackwardPass(); })});
+   r.timings.push_back({"ComputeAnisotropicWeights", time_repetitions(repetitions, [&]() { lp.ComputeAnisotropicWeights(); })});
+   double lb = 0.0;
+   r.timings.push_back({"LowerBound", time_repetitions(repetitions, [&]() { lb += lp.LowerBound(); })});
+   if(!std::isfinite(lb)) { throw std::runtime_error("lower bound not finite"); }
+   return r;
+}
+
+std::string to_json(const std::vector<benchmark_result>& results)
+{
+   std::stringstream s;
+   s << "{\n  \"benchmarks\": [\n";
+   for(INDEX i=0; i<results.size(); ++i) {
+      const auto& r = results[i];
+      s << "    {\"model\": \"" << r.model << "\", \"size\": " << r.size << ", \"factors\": " << r.no_factors << ", \"messages\": " << r.no_messages << ", \"timings\": {";
+      for(INDEX j=0; j<r.timings.size(); ++j) {
+         const auto& t = r.timings[j].second;
+         const double min = *std::min_element(t.begin(), t.end());
+         const double mean = std::accumulate(t.begin(), t.end(), 0.0) / t.size();
+         s << "\"" << r.timings[j].first << "\": {\"min\": " << min << ", \"mean\": " << mean << ", \"repetitions\": " << t.size() << "}";
+         if(j+1 < r.timings.size()) { s << ", "; }
+      }
+      s << "}}" << (i+1 < results.size() ? "," : "") << "\n";
+   }
+   s << "  ]\n}\n";
+   return s.str();
+}
+
+int main(int argc, char** argv)
+{
+   TCLAP::CmdLine cmd("message passing benchmark", ' ', "0.1");
+   TCLAP::ValueArg<INDEX> size_arg("","size","size of synthetic models: side length of grid, number of nodes otherwise",false,100,&positiveIntegerConstraint,cmd);
+   TCLAP::ValueArg<INDEX> repetitions_arg("","repetitions","number of timed repetitions of each operation",false,10,&positiveIntegerConstraint,cmd);
+   TCLAP::ValueArg<std::string> output_arg("o","output","file to write JSON results to, default: standard output",false,"","file name",cmd);
+   cmd.parse(argc, argv);
+
+   const INDEX n = size_arg.getValue();
+   std::vector<benchmark_result> results;
+   results.push_back(run_benchmark(benchmark_model_type::grid, n, repetitions_arg.getValue()));
+   results.push_back(run_benchmark(benchmark_model_type::random_sparse, n*n, repetitions_arg.getValue()));
+   results.push_back(run_benchmark(benchmark_model_type::chain, n*n, repetitions_arg.getValue()));
+
+   const std::string json = to_json(results);
+   if(output_arg.getValue() != "") {
+      std::ofstream f(output_arg.getValue());
+      f << json;
+   } else {
+      std::cout << json;
+   }
+}
@@ -0,0 +1,130 @@
+#include "graph.hxx"
+#include "csr_graph.hxx"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <cmath>
+#include <iostream>
+
+using namespace LP_MP;
+
+// compares the kernels for intersecting neighbourhoods in graph::for_each_triangle and csr_graph::for_each_triangle on power-law graphs, whose high degree nodes dominate triangle enumeration in cycle tightening.
+// Graphs are drawn from the Chung-Lu model: node i has expected degree proportional to (i+1)^(-1/(exponent-1)) and edge ij is present with probability proportional to the product of expected degrees.
+// usage: triangle_benchmark [--nodes <n>] [--averageDegree <d>] [--repetitions <n>] [--output <file>]
+
+struct empty_edge {};
+
+graph<empty_edge> power_law_graph(const std::size_t no_nodes, const double average_degree, const double exponent, const std::size_t seed)
+{
+   std::vector<double> weight(no_nodes);
+   for(std::size_t i=0; i<no_nodes; ++i) { weight[i] = std::pow(double(i+1), -1.0/(exponent-1.0)); }
+   const double scale = average_degree * no_nodes / std::accumulate(weight.begin(), weight.end(), 0.0);
+   for(auto& w : weight) { w *= scale; }
+   const double total_weight = std::accumulate(weight.begin(), weight.end(), 0.0);
+
+   // draw endpoints of no_nodes*average_degree/2 edges proportionally to their weights, drop loops and duplicates
+   std::mt19937 gen(seed);
+   std::discrete_distribution<std::size_t> endpoint(weight.begin(), weight.end());
+   std::vector<std::array<std::size_t,2>> edges;
+   const std::size_t no_edges = std::size_t(total_weight/2);
+   for(std::size_t e=0; e<no_edges; ++e) {
+      const std::size_t i = endpoint(gen);
+      const std::size_t j = endpoint(gen);
+      if(i != j) { edges.push_back({std::min(i,j), std::max(i,j)}); }
+   }
+   std::sort(edges.begin(), edges.end());
+   edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+   return graph<empty_edge>(edges.begin(), edges.end());
+}
+
+struct triangle_result {
+   double exponent;
+   std::string graph_type;
+   std::string kernel;
+   std::size_t no_edges;
+   std::size_t max_degree;
+   std::size_t no_triangles;
+   std::vector<double> times; // seconds per repetition
+};
+
+std::string to_string(const triangle_intersection_kernel k)
+{
+   switch(k) {
+      case triangle_intersection_kernel::adaptive: return "adaptive";
+      case triangle_intersection_kernel::merge: return "merge";
+      case triangle_intersection_kernel::galloping: return "galloping";
+      case triangle_intersection_kernel::bitset: return "bitset";
+   }
+   return "";
+}
+
+template<typename GRAPH>
+triangle_result run_benchmark(const GRAPH& g, const std::string& graph_type, const double exponent, const triangle_intersection_kernel kernel, const std::size_t repetitions)
+{
+   triangle_result r{exponent, graph_type, to_string(kernel), 0, 0, 0, {}};
+   for(std::size_t i=0; i<g.no_nodes(); ++i) {
+      r.no_edges += g.no_edges(i);
+      r.max_degree = std::max(r.max_degree, g.no_edges(i));
+   }
+   r.no_edges /= 2;
+   for(std::size_t rep=0; rep<repetitions; ++rep) {
+      std::size_t no_triangles = 0;
+      const auto begin = std::chrono::steady_clock::now();
+      g.for_each_triangle([&](const std::size_t, const std::size_t, const std::size_t, const auto&, const auto&, const auto&) { ++no_triangles; }, kernel);
+      r.times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+      if(rep > 0 && no_triangles != r.no_triangles) { throw std::runtime_error("number of triangles differs between repetitions"); }
+      r.no_triangles = no_triangles;
+   }
+   return r;
+}
+
+std::string to_json(const std::vector<triangle_result>& results)
+{
+   std::stringstream s;
+   s << "{\n  \"benchmarks\": [\n";
+   for(std::size_t i=0; i<results.size(); ++i) {
+      const auto& r = results[i];
+      const double min = *std::min_element(r.times.begin(), r.times.end());
+      const double mean = std::accumulate(r.times.begin(), r.times.end(), 0.0) / r.times.size();
+      s << "    {\"exponent\": " << r.exponent << ", \"graph\": \"" << r.graph_type << "\", \"kernel\": \"" << r.kernel << "\", \"edges\": " << r.no_edges << ", \"max_degree\": " << r.max_degree
+        << ", \"triangles\": " << r.no_triangles << ", \"time\": {\"min\": " << min << ", \"mean\": " << mean << ", \"repetitions\": " << r.times.size() << "}}"
+        << (i+1 < results.size() ? "," : "") << "\n";
+   }
+   s << "  ]\n}\n";
+   return s.str();
+}
+
+int main(int argc, char** argv)
+{
+   TCLAP::CmdLine cmd("triangle enumeration benchmark on power-law graphs", ' ', "0.1");
+   TCLAP::ValueArg<INDEX> nodes_arg("","nodes","number of nodes",false,200000,&positiveIntegerConstraint,cmd);
+   TCLAP::ValueArg<REAL> degree_arg("","averageDegree","expected average degree",false,20.0,"positive real",cmd);
+   TCLAP::ValueArg<INDEX> repetitions_arg("","repetitions","number of timed enumerations per kernel",false,3,&positiveIntegerConstraint,cmd);
+   TCLAP::ValueArg<std::string> output_arg("o","output","file to write JSON results to, default: standard output",false,"","file name",cmd);
+   cmd.parse(argc, argv);
+
+   std::vector<triangle_result> results;
+   // smaller exponents give heavier tails, i.e. hubs of higher degree
+   for(const double exponent : {2.1, 2.5, 3.0}) {
+      const auto g = power_law_graph(nodes_arg.getValue(), degree_arg.getValue(), exponent, 0);
+      const std::size_t first = results.size();
+      for(const auto k : {triangle_intersection_kernel::merge, triangle_intersection_kernel::galloping, triangle_intersection_kernel::bitset, triangle_intersection_kernel::adaptive}) {
+         results.push_back(run_benchmark(g, "graph", exponent, k, repetitions_arg.getValue()));
+         if(results.back().no_triangles != results[first].no_triangles) { throw std::runtime_error("kernels enumerate different numbers of triangles"); }
+      }
+      const csr_graph<empty_edge> c(g);
+      for(const auto k : {triangle_intersection_kernel::merge, triangle_intersection_kernel::adaptive}) {
+         results.push_back(run_benchmark(c, "csr_graph", exponent, k, repetitions_arg.getValue()));
+         if(results.back().no_triangles != results[first].no_triangles) { throw std::runtime_error("graph representations enumerate different numbers of triangles"); }
+      }
+   }
+
+   const std::string json = to_json(results);
+   if(output_arg.getValue() != "") {
+      std::ofstream f(output_arg.getValue());
+      f << json;
+   } else {
+      std::cout << json;
+   }
+}
@@ -15,11 +15,25 @@ public:
    // to do: change the FWMAP implementation and make these methods virtual instead of static.
    // _y is the primal labeling to be computed
    // wi is the Lagrangean variables
+   // only state of the tree passed in term_data is touched, hence max_fn may be called for different trees concurrently
    static double max_fn(double* wi, FWMAP::YPtr _y, FWMAP::TermData term_data)
    {
      
       LP_tree_Lagrangean<FMC, Lagrangean_factor_FWMAP>* t = (LP_tree_Lagrangean<FMC, Lagrangean_factor_FWMAP>*) term_data;
 
+      if(t->sparse_weights_) {
+         // weights stay in the tree, only the ones changed since the last call are updated
+         t->set_weights(wi, +1.0);
+         t->solve();
+         t->save_primal(_y);
+         // cost without the Lagrangean term
+         double v = t->primal_cost();
+         for(auto& L : t->Lagrangean_factors_) {
+            v -= L.dot_product_fn(wi);
+         }
+         return v;
+      }
+
       // first add weights to problem
       // we only need to add Lagrange variables to Lagrangean_factors_ (others are not shared)
       t->add_weights(wi, +1.0);
@@ -68,6 +82,9 @@ public:
 
    void Begin()
    {
+#ifdef LP_MP_PARALLEL
+       this->init_executor();
+#endif
        LP_with_trees<FMC_TYPE, Lagrangean_factor_FWMAP, LP_tree_FWMAP<FMC_TYPE> >::construct_decomposition();
        bundle_solver = build_up_solver();
    }
@@ -93,7 +110,7 @@ public:
       return bundle_solver;
    }
 
-   REAL decomposition_lower_bound() const
+   REAL decomposition_lower_bound()
    {
      const auto lb2 = LP_with_trees<FMC_TYPE, Lagrangean_factor_FWMAP, LP_tree_FWMAP<FMC_TYPE> >::decomposition_lower_bound();
      std::cout << "remove me lb = " << lb2 << "\n";
@@ -11,6 +11,7 @@
 #include <functional>
 #include <utility>
 #include <limits>
+#include <cstdint>
 #include <exception>
 #include <unordered_map>
 #include <unordered_set>
@@ -22,21 +23,33 @@
 #include "two_dimensional_variable_array.hxx"
 #include "union_find.hxx"
 #include <thread>
+#include <atomic>
 #include <future>
 #include "memory_allocator.hxx"
+#include "work_stealing_schedule.hxx"
+#include "graph_coloring.hxx"
+#include "priority_schedule.hxx"
+#include "executor.hxx"
+#include "reduction.hxx"
+#include "locality_ordering.hxx"
 #include "serialization.hxx"
+#include "numa.hxx"
+#include "model_file.hxx"
+#include "function_existence.hxx"
+#include <fstream>
 #include "tclap/CmdLine.h"
 #include "DD_ILP.hxx"
 
-#ifdef LP_MP_PARALLEL
-#include <omp.h>
-#endif
 
 namespace LP_MP {
 
 // forward declaration
 class MessageIterator;
 
+namespace FunctionExistence {
+LP_MP_FUNCTION_EXISTENCE_CLASS(has_serialize_construction, serialize_construction)
+}
+
 using weight_array = two_dim_variable_array<REAL>;
 using weight_slice = two_dim_variable_array<REAL>::ArrayAccessObject;
 using receive_array = two_dim_variable_array<unsigned char>;
@@ -67,6 +80,13 @@ public:
    virtual INDEX no_send_messages() const = 0;
    virtual INDEX no_receive_messages() const = 0;
    virtual REAL LowerBound() const = 0;
+   virtual REAL lower_bound_cached() = 0; // LowerBound(), recomputed only when the factor was changed since the last call
+   virtual bool lower_bound_valid() const = 0; // whether lower_bound_cached() returns without recomputation
+   virtual void invalidate_lower_bound() = 0;
+   // sum of absolute values of messages received since the last reset, accumulated only when tracking is switched on
+   virtual void track_received_change(const bool track) = 0;
+   virtual REAL received_change() const = 0;
+   virtual void reset_received_change() = 0;
    virtual void init_primal() = 0;
    virtual void MaximizePotentialAndComputePrimal() = 0;
    virtual void propagate_primal_through_messages() = 0;
@@ -92,6 +112,8 @@ public:
 
    virtual void divide(const REAL val) = 0; // divide potential by value
    virtual void add(FactorTypeAdapter*) = 0; // add potential values of other factor
+   virtual void numa_pages(std::vector<void*>& pages) = 0; // append pages of factor container and dual memory, for migrating them to a numa node
+   virtual void relocate_dual() = 0; // copy dual memory held outside of the factor container to newly allocated memory
 
    virtual INDEX dual_size() = 0;
    virtual INDEX dual_size_in_bytes() = 0;
@@ -197,6 +219,15 @@ inline MessageIterator FactorTypeAdapter::end()  { return MessageIterator(this,
 */
 
 
+// cumulative number of factor updates performed and skipped because of convergence, see --skipConvergedFactors,
+// and of factor lower bounds recomputed and taken from the cache, see --incrementalLowerBound
+struct factor_update_statistics {
+   std::size_t updated = 0;
+   std::size_t skipped = 0;
+   std::size_t lower_bounds_recomputed = 0;
+   std::size_t lower_bounds_cached = 0;
+};
+
 template<typename FMC_TYPE>
 class LP {
    struct message_trait
@@ -254,6 +285,12 @@ public:
 
    INDEX GetNumberOfFactors() const { return f_.size(); }
    FactorTypeAdapter* GetFactor(const INDEX i) const { return f_[i]; }
+   const std::vector<FactorTypeAdapter*>& forward_update_ordering() { SortFactors(); return forwardUpdateOrdering_; }
+
+   // executor for all parallel work. If none is set, Begin creates one according to --executor and --numLpThreads.
+   // Several LPs may share one executor.
+   void set_executor(std::shared_ptr<executor> e) { executor_ = e; set_flags_dirty(); }
+   executor& get_executor() const { return executor_ ? *executor_ : default_executor(); }
 
    template<typename MESSAGE_CONTAINER_TYPE>
    static constexpr std::size_t message_tuple_index()
@@ -315,7 +352,15 @@ public:
    }
 
    void Begin(); // must be called after all messages and factors have been added
-   void End() {};
+   void End()
+   {
+#ifdef LP_MP_PARALLEL
+     if(diagnostics()) {
+       print_schedule_statistics(forward_schedule_, "forward");
+       print_schedule_statistics(backward_schedule_, "backward");
+     }
+#endif
+   }
 
    void SortFactors(
          const std::vector<std::pair<FactorTypeAdapter*, FactorTypeAdapter*>>& factor_rel,
@@ -325,6 +370,34 @@ public:
          );
 
    void SortFactors();
+   void set_ordering(const std::vector<INDEX>& f_sorted, std::vector<FactorTypeAdapter*>& ordering, std::vector<FactorTypeAdapter*>& update_ordering);
+   std::vector<std::uint32_t> factor_types() const;
+
+   // binary snapshot of factors, messages, factor relations, orderings and potentials, see model_file.hxx.
+   // load_model rebuilds the problem in an empty LP without the original input: factors and message operations are default constructed,
+   // then read their optional construction record through serialize_construction(ARCHIVE&), e.g. sizes determining their dual memory, and finally their potentials.
+   // Problem constructors are not rebuilt, hence their index maps for writing solutions are not available after loading.
+   void save_model(const std::string& filename);
+   void load_model(const std::string& filename);
+
+   // take over orderings, weights and synchronization computed by o, which must have the same factor types, messages and factor relations added in the same order.
+   // The reparametrization mode of o is set as well, potentials are not copied.
+   void copy_preprocessing(const LP& o);
+
+   // must be called after potentials were changed other than by message passing, e.g. by loading them into the factors.
+   // Cached lower bounds and convergence state are reset, orderings and weights are kept.
+   void potentials_changed();
+
+   // warm start: change the potentials of factor f in place through update(*f->GetFactor()), keeping the current reparametrization, orderings and weights.
+   // Under --skipConvergedFactors and priority reparametrization only f and its neighbours are updated again, until the change propagates further.
+   template<typename FACTOR_CONTAINER_TYPE, typename FUNC>
+   void update_potentials(FACTOR_CONTAINER_TYPE* f, FUNC update)
+   {
+      update(*f->GetFactor());
+      potentials_changed(f);
+   }
+   // only the potentials of f were changed
+   void potentials_changed(FactorTypeAdapter* f);
 
    //void ComputeWeights(const LPReparametrizationMode m);
    void set_reparametrization(const LPReparametrizationMode r) { repamMode_ = r; }
@@ -361,6 +434,8 @@ public:
    template<typename FACTOR_ITERATOR>
    void compute_full_receive_mask(FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end, receive_array& receive_mask);
 
+   // With --incrementalLowerBound only factors changed since the last call are recomputed. Every factor updated by a pass is changed,
+   // hence this saves work only if few factors are updated between calls, e.g. under --skipConvergedFactors or priority reparametrization.
    double LowerBound() const;
    double EvaluatePrimal();
 
@@ -384,12 +459,17 @@ public:
    template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR, typename RECEIVE_MASK_ITERATOR>
    void ComputePass(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorItEnd, OMEGA_ITERATOR omegaIt, RECEIVE_MASK_ITERATOR receive_it);
 
+   template<typename FACTOR_BATCHES, typename OMEGA_ITERATOR, typename RECEIVE_MASK_ITERATOR>
+   void ComputePassBatched(FACTOR_BATCHES& batches, OMEGA_ITERATOR omega_begin, RECEIVE_MASK_ITERATOR receive_begin, const bool reverse_types);
+
 #ifdef LP_MP_PARALLEL
-   template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR, typename SYNCHRONIZATION_ITERATOR>
+   template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR, typename RECEIVE_MASK_ITERATOR, typename SYNCHRONIZATION_ITERATOR>
    void ComputePassSynchronized(
        FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorItEnd, 
        OMEGA_ITERATOR omega_begin, OMEGA_ITERATOR omega_end,
-       SYNCHRONIZATION_ITERATOR synchronization_begin, SYNCHRONIZATION_ITERATOR synchronization_end);
+       RECEIVE_MASK_ITERATOR receive_begin,
+       SYNCHRONIZATION_ITERATOR synchronization_begin, SYNCHRONIZATION_ITERATOR synchronization_end,
+       work_stealing_schedule& schedule);
 
    template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR, typename SYNCHRONIZATION_ITERATOR>
    void ComputePassAndPrimalSynchronized(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorEndIt, OMEGA_ITERATOR omegaIt, SYNCHRONIZATION_ITERATOR, const INDEX iteration);
@@ -416,7 +496,9 @@ public:
 
 #ifdef LP_MP_PARALLEL
       compute_synchronization();
+      if(parallel_schedule_ == parallel_schedule_type::coloring) { compute_coloring(); }
 #endif 
+      if(batched_factor_update_arg_.getValue()) { compute_factor_batches(); }
       if(repamMode_ != LPReparametrizationMode::Anisotropic) {
           if(!full_receive_mask_valid_) {
               compute_full_receive_mask();
@@ -461,6 +543,8 @@ public:
 
    void add_to_constant(const REAL x) { constant_ += x; }
 
+   const factor_update_statistics& update_statistics() const { return update_statistics_; }
+
    // methods for staged optimization
    void put_in_same_partition(FactorTypeAdapter* f1, FactorTypeAdapter* f2) { factor_partition_valid_ = false; partition_graph.push_back({f1,f2}); }
 
@@ -495,6 +579,48 @@ protected:
 
    message_storage_type messages_;
 
+   // factors of the update orderings grouped by type, together with their position in the update ordering (for indexing weights and receive masks).
+   // Batched passes go through them type by type, so that the final UpdateFactor of the concrete factor container is called without virtual dispatch.
+   // Forward passes visit the types in the order of FMC::FactorList, backward passes in reverse order.
+   struct vector_of_indexed_pointers {
+      template<class T> 
+         using invoke = typename std::vector<std::pair<T*,INDEX>>;
+   };
+   using factor_batch_list = meta::transform< typename FMC::FactorList, vector_of_indexed_pointers >;
+   using factor_batch_storage_type = meta::apply<meta::quote<std::tuple>, factor_batch_list>;
+
+   bool factor_batches_valid_ = false;
+   factor_batch_storage_type forward_factor_batches_, backward_factor_batches_;
+   void compute_factor_batches();
+   void compute_factor_batches(const std::vector<FactorTypeAdapter*>& update_ordering, factor_batch_storage_type& batches);
+
+   // indices of factors connected by a message, indexed like f_. Computed once and shared by coloring, relocation, priority scheduling and skipping.
+   bool factor_adjacency_valid_ = false;
+   two_dim_variable_array<INDEX> factor_adjacency_;
+   const two_dim_variable_array<INDEX>& factor_adjacency();
+
+   // priority scheduling: factors of forwardUpdateOrdering_ are updated in order of the message change they received since their last update.
+   // The message change is accumulated by the factors while messages reparametrize them, hence no lower bounds are evaluated to maintain priorities.
+   // Factors with priority not above the threshold are not updated at all, until a neighbour changes them again.
+   // The queue is processed by one thread, hence priority reparametrization is rejected in parallel builds.
+   bool priority_schedule_valid_ = false;
+   indexed_priority_queue priority_queue_; // over indices into forwardUpdateOrdering_
+   std::vector<INDEX> priority_position_; // position in forwardUpdateOrdering_ of factors in f_, max if not updated
+   two_dim_variable_array<INDEX> priority_update_neighbours_; // adjacent factors in forwardUpdateOrdering_
+   void compute_priority_schedule();
+   void compute_priority_pass();
+
+   // skipping of converged factors: a factor is updated only if the messages it received since its last update changed it by more than the tolerance in total.
+   // All factors are active again after the factors, the reparametrization mode or, through a primal pass, the reparametrization of all factors changed.
+   bool skip_state_valid_ = false;
+   LPReparametrizationMode skip_repam_mode_ = LPReparametrizationMode::Undefined;
+   std::vector<unsigned char> factor_active_; // indexed like f_
+   std::vector<INDEX> forward_update_index_, backward_update_index_; // index in f_ of factors in update orderings
+   mutable factor_update_statistics update_statistics_; // LowerBound() counts cache hits
+   void compute_skip_state();
+   template<typename OMEGA_ITERATOR, typename RECEIVE_MASK_ITERATOR>
+   void ComputePassSkipping(const std::vector<FactorTypeAdapter*>& update_ordering, const std::vector<INDEX>& update_index, OMEGA_ITERATOR omega_it, RECEIVE_MASK_ITERATOR receive_it);
+
 
    bool ordering_valid_ = false;
    std::vector<FactorTypeAdapter*> forwardOrdering_, backwardOrdering_; // separate forward and backward ordering are not needed: Just store factorOrdering_ and generate forward order by begin() and backward order by rbegin().
@@ -522,18 +648,50 @@ protected:
    std::unordered_map<FactorTypeAdapter*,INDEX> factor_address_to_index_;
    std::vector<INDEX> f_forward_sorted_, f_backward_sorted_; // sorted indices in factor vector f_ 
 
+   std::vector<std::array<INDEX,2>> message_types() const; // type of each message in m_ and its position among messages of that type
+   template<typename T, typename ARCHIVE>
+   static void serialize_construction(T& t, ARCHIVE& ar)
+   {
+      if constexpr(FunctionExistence::has_serialize_construction<T, void, ARCHIVE>()) { t.serialize_construction(ar); }
+   }
+
    LPReparametrizationMode repamMode_ = LPReparametrizationMode::Undefined;
 
-   TCLAP::ValueArg<std::string> reparametrization_type_arg_; // shared|residual|partition|overlapping_partition|adaptive
+   TCLAP::ValueArg<std::string> reparametrization_type_arg_; // shared|residual|partition|overlapping_partition|adaptive|priority
    TCLAP::ValueArg<INDEX> inner_iteration_number_arg_;
-   enum class reparametrization_type {shared,residual,partition,overlapping_partition,adaptive};
+   TCLAP::SwitchArg batched_factor_update_arg_;
+   TCLAP::SwitchArg incremental_lower_bound_arg_;
+   TCLAP::ValueArg<REAL> priority_threshold_arg_;
+   TCLAP::SwitchArg skip_converged_factors_arg_;
+   TCLAP::ValueArg<REAL> skip_tolerance_arg_;
+   TCLAP::ValueArg<std::string> relocate_factors_arg_; // none|update|rcm
+   std::shared_ptr<executor> executor_;
+   void relocate_factors();
+   enum class reparametrization_type {shared,residual,partition,overlapping_partition,adaptive,priority};
    reparametrization_type reparametrization_type_;
 #ifdef LP_MP_PARALLEL
    TCLAP::ValueArg<INDEX> num_lp_threads_arg_;
+   TCLAP::ValueArg<std::string> parallel_schedule_arg_; // static|work_stealing|coloring
+   TCLAP::ValueArg<INDEX> schedule_chunk_size_arg_;
+   TCLAP::SwitchArg numa_arg_;
+   TCLAP::ValueArg<std::string> executor_arg_; // openmp|thread_pool
+   enum class parallel_schedule_type {static_schedule, work_stealing, coloring};
+   parallel_schedule_type parallel_schedule_;
+   work_stealing_schedule forward_schedule_, backward_schedule_;
+   void print_schedule_statistics(const work_stealing_schedule& s, const std::string& pass_name) const;
+   void place_factors_numa();
+   void init_executor();
    bool synchronization_valid_ = false;
    std::vector<bool> synchronize_forward_;
    std::vector<bool> synchronize_backward_;
 
+   // color classes hold indices into forwardUpdateOrdering_ resp. backwardUpdateOrdering_. Factors of one class can be updated in parallel without locking.
+   bool coloring_valid_ = false;
+   two_dim_variable_array<INDEX> color_classes_forward_, color_classes_backward_;
+   void compute_coloring();
+   template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR, typename RECEIVE_MASK_ITERATOR>
+   void ComputePassColored(FACTOR_ITERATOR factor_begin, OMEGA_ITERATOR omega_begin, RECEIVE_MASK_ITERATOR receive_begin, const two_dim_variable_array<INDEX>& color_classes, const bool reverse_color_order, work_stealing_schedule& schedule);
+
    template<typename ITERATOR>
    std::vector<bool> compute_synchronization(ITERATOR factor_begin, ITERATOR factor_end);
 
@@ -557,7 +715,7 @@ protected:
    template<typename ITERATOR_1, typename ITERATOR_2>
    std::vector<FactorTypeAdapter*> concatenate_factors(ITERATOR_1 f1_begin, ITERATOR_1 f1_end, ITERATOR_2 f2_begin, ITERATOR_2 f2_end);
 
-   REAL constant_ = 0;
+   REAL_ACCUMULATOR constant_ = 0;
 
 
    // for staged optimization: partition factors that are updated and run multiple rounds of optimization on each component of the partition followed by pushing messages to the next component.
@@ -586,10 +744,20 @@ protected:
 
 template<typename FMC> 
 LP<FMC>::LP(TCLAP::CmdLine& cmd)
-: reparametrization_type_arg_("","reparametrizationType","message sending type: ", false, "shared", "{shared|residual|partition|overlapping_partition|adaptive}", cmd)
+: reparametrization_type_arg_("","reparametrizationType","message sending type, priority is only supported for sequential message passing: ", false, "shared", "{shared|residual|partition|overlapping_partition|adaptive|priority}", cmd)
 , inner_iteration_number_arg_("","innerIteration","number of iterations in inner loop in partition reparamtrization, default = 5",false,5,&positiveIntegerConstraint,cmd) 
+, batched_factor_update_arg_("","batchedFactorUpdate","update factors type by type instead of in the order given by the factor relations", cmd, false)
+, incremental_lower_bound_arg_("","incrementalLowerBound","cache lower bounds of factors and recompute only those of factors changed since the last lower bound computation, pays off with --skipConvergedFactors or priority reparametrization", cmd, false)
+, priority_threshold_arg_("","priorityThreshold","in priority reparametrization, factors whose received message change is not above this value are not updated, default = eps",false,eps,"positive real",cmd)
+, skip_converged_factors_arg_("","skipConvergedFactors","do not update factors none of whose neighbours changed in the last pass", cmd, false)
+, skip_tolerance_arg_("","skipTolerance","total absolute change of received messages below which a factor is regarded as converged and not updated, default = eps",false,eps,"positive real",cmd)
+, relocate_factors_arg_("","relocateFactors","reallocate dual memory of factors consecutively in forward update order or in reverse Cuthill-McKee order of the factor graph, default = none",false,"none","{none|update|rcm}",cmd)
 #ifdef LP_MP_PARALLEL
 , num_lp_threads_arg_("","numLpThreads","number of threads for message passing, default = 1",false,1,&positiveIntegerConstraint,cmd)
+, parallel_schedule_arg_("","parallelSchedule","distribution of factor updates onto threads: static blocks, work stealing of chunks or lock-free updates of color classes, default = static",false,"static","{static|work_stealing|coloring}",cmd)
+, schedule_chunk_size_arg_("","scheduleChunkSize","number of consecutive factors in one chunk for work stealing, default = 64",false,64,&positiveIntegerConstraint,cmd)
+, numa_arg_("","numa","pin threads to numa nodes and move factors to the node of the threads updating them in the forward and backward pass", cmd, false)
+, executor_arg_("","executor","threads running parallel message passing, ignored if an executor was set programmatically, default = openmp",false,"openmp","{openmp|thread_pool}",cmd)
 #endif
 {}
 
@@ -599,82 +767,73 @@ LP<FMC>::~LP()
   for(INDEX i=0; i<f_.size(); i++) { delete f_[i]; }
 }
 
-// make a deep copy of factors and messages. Adjust pointers to messages and factors
+// make a deep copy of factors and messages with the same orderings and weights. The executor is shared with o.
 template<typename FMC>
 LP<FMC>::LP(LP& o) // no const because of o.num_lp_threads_arg_.getValue() not being const!
-  : reparametrization_type_arg_("","reparametrizationType","message sending type: ", false, o.reparametrization_type_arg_.getValue(), "{shared|residual|partition|overlapping_partition|adaptive}" )
+  : reparametrization_type_arg_("","reparametrizationType","message sending type, priority is only supported for sequential message passing: ", false, o.reparametrization_type_arg_.getValue(), "{shared|residual|partition|overlapping_partition|adaptive|priority}" )
 , inner_iteration_number_arg_("","innerIteration","number of iterations in inner loop in partition reparamtrization, default = 5",false,o.inner_iteration_number_arg_.getValue(),&positiveIntegerConstraint) 
+, batched_factor_update_arg_("","batchedFactorUpdate","update factors type by type instead of in the order given by the factor relations", o.batched_factor_update_arg_.getValue())
+, incremental_lower_bound_arg_("","incrementalLowerBound","cache lower bounds of factors and recompute only those of factors changed since the last lower bound computation, pays off with --skipConvergedFactors or priority reparametrization", o.incremental_lower_bound_arg_.getValue())
+, priority_threshold_arg_("","priorityThreshold","in priority reparametrization, factors whose received message change is not above this value are not updated, default = eps",false,o.priority_threshold_arg_.getValue(),"positive real")
+, skip_converged_factors_arg_("","skipConvergedFactors","do not update factors none of whose neighbours changed in the last pass", o.skip_converged_factors_arg_.getValue())
+, skip_tolerance_arg_("","skipTolerance","total absolute change of received messages below which a factor is regarded as converged and not updated, default = eps",false,o.skip_tolerance_arg_.getValue(),"positive real")
+, relocate_factors_arg_("","relocateFactors","reallocate dual memory of factors consecutively in forward update order or in reverse Cuthill-McKee order of the factor graph, default = none",false,o.relocate_factors_arg_.getValue(),"{none|update|rcm}")
 #ifdef LP_MP_PARALLEL
     , num_lp_threads_arg_("","numLpThreads","number of threads for message passing, default = 1",false,o.num_lp_threads_arg_.getValue(),&positiveIntegerConstraint)
+    , parallel_schedule_arg_("","parallelSchedule","distribution of factor updates onto threads: static blocks, work stealing of chunks or lock-free updates of color classes, default = static",false,o.parallel_schedule_arg_.getValue(),"{static|work_stealing|coloring}")
+    , schedule_chunk_size_arg_("","scheduleChunkSize","number of consecutive factors in one chunk for work stealing, default = 64",false,o.schedule_chunk_size_arg_.getValue(),&positiveIntegerConstraint)
+    , numa_arg_("","numa","pin threads to numa nodes and move factors to the node of the threads updating them in the forward and backward pass", o.numa_arg_.getValue())
+    , executor_arg_("","executor","threads running parallel message passing, ignored if an executor was set programmatically, default = openmp",false,o.executor_arg_.getValue(),"{openmp|thread_pool}")
 #endif
 {
-  f_.reserve(o.f_.size());
-  assert(false);
-  std::map<FactorTypeAdapter*, FactorTypeAdapter*> factor_map; // translate addresses from o's factors to this' factors
-  f_.reserve(o.f_.size());
-  for(auto* f : o.f_) {
-    auto* clone = f->clone();
-    assert(false);
-    //this->AddFactor(clone);
-    factor_map.insert(std::make_pair(f, clone));
-  }
-  m_.reserve(o.m_.size());
-  for(auto m : o.m_) {
-    auto* left = m.left;
-    auto* right = m.right;
-    auto* left_clone = factor_map[left];
-    auto* right_clone = factor_map[right];
-    m_.push_back({left_clone, right_clone, m.sends_message_to_left, m.sends_message_to_right, m.receives_message_from_left, m.receives_message_from_right});
-  }
-
-  ordering_valid_ = o.ordering_valid_;
-  omega_anisotropic_valid_ = o.omega_anisotropic_valid_ ;
-  omega_anisotropic2_valid_ = o.omega_anisotropic2_valid_;
-  omega_isotropic_valid_ = o.omega_isotropic_valid_ ;
-  omega_isotropic_damped_valid_ = o.omega_isotropic_damped_valid_ ;
-  omega_mixed_valid_ = o.omega_mixed_valid_;
-
-  omegaForwardAnisotropic_ = o.omegaForwardAnisotropic_; 
-  omegaBackwardAnisotropic_ = o.omegaBackwardAnisotropic_;
-  omegaForwardAnisotropic2_ = o.omegaForwardAnisotropic_; 
-  omegaBackwardAnisotropic2_ = o.omegaBackwardAnisotropic_;
-  omegaForwardIsotropic_ = o.omegaForwardIsotropic_; 
-  omegaBackwardIsotropic_ = o.omegaBackwardIsotropic_;
-  omegaForwardIsotropicDamped_ = o.omegaForwardIsotropicDamped_; 
-  omegaBackwardIsotropicDamped_ = o.omegaBackwardIsotropicDamped_;
-  omegaForwardMixed_ = o.omegaForwardMixed_; 
-  omegaBackwardMixed_ = o.omegaBackwardMixed_;
-
-  forwardOrdering_.reserve(o.forwardOrdering_.size());
-  for(auto* f : o.forwardOrdering_) {
-    forwardOrdering_.push_back( factor_map[f] );
-  }
-
-  backwardOrdering_.reserve(o.backwardOrdering_.size());
-  for(auto* f : o.backwardOrdering_) {
-    backwardOrdering_.push_back( factor_map[f] );
+  // factors are cloned type by type. Messages are embedded in the factors, hence they are added anew between the clones with copies of the message operations.
+  f_.resize(o.f_.size());
+  for_each_tuple(o.factors_, [&](auto& v) {
+      using factor_container_type = typename std::remove_pointer<typename std::remove_reference<decltype(v)>::type::value_type>::type;
+      constexpr auto n = factor_tuple_index<factor_container_type>();
+      for(auto* f : v) {
+        auto* clone = new factor_container_type(*f->GetFactor());
+        f_[o.factor_address_to_index_.find(f)->second] = clone;
+        std::get<n>(factors_).push_back(clone);
+      }
+  });
+  for(INDEX i=0; i<f_.size(); ++i) {
+    factor_address_to_index_.insert(std::make_pair(f_[i], i));
   }
 
-  forwardUpdateOrdering_.reserve(o.forwardUpdateOrdering_.size());
-  for(auto* f : o.forwardUpdateOrdering_) {
-    forwardUpdateOrdering_.push_back( factor_map[f] );
+  for_each_tuple(o.messages_, [&](auto& v) {
+      using message_container_type = typename std::remove_pointer<typename std::remove_reference<decltype(v)>::type::value_type>::type;
+      using left_factor_type = typename message_container_type::LeftFactorContainer;
+      using right_factor_type = typename message_container_type::RightFactorContainer;
+      for(auto* m : v) {
+        auto* l = static_cast<left_factor_type*>(f_[o.factor_address_to_index_.find(m->GetLeftFactor())->second]);
+        auto* r = static_cast<right_factor_type*>(f_[o.factor_address_to_index_.find(m->GetRightFactor())->second]);
+        this->template add_message<message_container_type>(l, r, m->GetMessageOp());
+      }
+  });
+  // messages were added grouped by type, restore the order of o
+  auto clone_of = [&](FactorTypeAdapter* f) { return f_[o.factor_address_to_index_.find(f)->second]; };
+  m_.clear();
+  for(const auto& m : o.m_) {
+    m_.push_back({clone_of(m.left), clone_of(m.right), m.sends_message_to_left, m.sends_message_to_right, m.receives_message_from_left, m.receives_message_from_right});
   }
 
-  backwardUpdateOrdering_.reserve(o.backwardUpdateOrdering_.size());
-  for(auto* f : o.backwardUpdateOrdering_) {
-    backwardUpdateOrdering_.push_back( factor_map[f] );
+  for(auto rel : o.forward_pass_factor_rel_) {
+    forward_pass_factor_rel_.push_back(std::make_pair(clone_of(rel.first), clone_of(rel.second)));
   }
-
-  forward_pass_factor_rel_.reserve(o.forward_pass_factor_rel_.size());
-  for(auto f : o.forward_pass_factor_rel_) {
-    forward_pass_factor_rel_.push_back( std::make_pair(factor_map[f.first], factor_map[f.second]) );
+  for(auto rel : o.backward_pass_factor_rel_) {
+    backward_pass_factor_rel_.push_back(std::make_pair(clone_of(rel.first), clone_of(rel.second)));
   }
 
-  backward_pass_factor_rel_.reserve(o.backward_pass_factor_rel_.size());
-  for(auto f : o.backward_pass_factor_rel_) {
-    backward_pass_factor_rel_.push_back( std::make_pair(factor_map[f.first], factor_map[f.second]) );
+  executor_ = o.executor_;
+  reparametrization_type_ = o.reparametrization_type_;
+#ifdef LP_MP_PARALLEL
+  parallel_schedule_ = o.parallel_schedule_;
+#endif
+  if(o.ordering_valid_) {
+    copy_preprocessing(o);
   }
-
+  repamMode_ = o.repamMode_;
   constant_ = o.constant_;
 }
 
@@ -717,13 +876,47 @@ inline void LP<FMC>::Begin()
      reparametrization_type_ = reparametrization_type::overlapping_partition;
    } else if(reparametrization_type_arg_.getValue() == "adaptive") {
      reparametrization_type_ = reparametrization_type::adaptive;
+   } else if(reparametrization_type_arg_.getValue() == "priority") {
+     reparametrization_type_ = reparametrization_type::priority;
    } else {
      assert(false);
    }
 
+   if(relocate_factors_arg_.getValue() != "none") {
+     relocate_factors();
+   }
+
 #ifdef LP_MP_PARALLEL
-   omp_set_num_threads(num_lp_threads_arg_.getValue());
-   if(debug()) { std::cout << "number of threads = " << num_lp_threads_arg_.getValue() << "\n"; }
+   if(skip_converged_factors_arg_.getValue()) {
+     throw std::runtime_error("--skipConvergedFactors is only supported for sequential message passing");
+   }
+   if(reparametrization_type_ == reparametrization_type::priority) {
+     throw std::runtime_error("priority reparametrization is only supported for sequential message passing");
+   }
+   init_executor();
+   if(numa_arg_.getValue() && dynamic_cast<openmp_executor*>(executor_.get()) == nullptr) {
+     throw std::runtime_error("--numa requires the openmp executor, other executors do not run tasks on fixed threads");
+   }
+   if(debug()) { std::cout << "number of threads = " << get_executor().no_threads() << "\n"; }
+   if(parallel_schedule_arg_.getValue() == "static") {
+     parallel_schedule_ = parallel_schedule_type::static_schedule;
+   } else if(parallel_schedule_arg_.getValue() == "work_stealing") {
+     parallel_schedule_ = parallel_schedule_type::work_stealing;
+   } else if(parallel_schedule_arg_.getValue() == "coloring") {
+     parallel_schedule_ = parallel_schedule_type::coloring;
+   } else {
+     throw std::runtime_error("parallel schedule not supported: " + parallel_schedule_arg_.getValue());
+   }
+   forward_schedule_.reset_statistics();
+   backward_schedule_.reset_statistics();
+   if(parallel_schedule_ == parallel_schedule_type::coloring) {
+     SortFactors();
+     compute_coloring();
+   }
+   if(numa_arg_.getValue()) {
+     SortFactors();
+     place_factors_numa();
+   }
 #endif 
 }
 
@@ -755,6 +948,23 @@ void LP<FMC>::SortFactors(
   //std::vector<INDEX> sortedIndices = g.topologicalSort();
   assert(f_sorted.size() == f_.size());
 
+  set_ordering(f_sorted, ordering, update_ordering);
+  // check whether sorting was successful
+  /*
+     std::map<FactorTypeAdapter*, INDEX> factorToIndexSorted;
+     std::map<INDEX, FactorTypeAdapter*> indexToFactorSorted;
+     BuildIndexMaps(ordering.begin(), ordering.end(), factorToIndexSorted, indexToFactorSorted);
+     for(auto rel : factor_rel) {
+     const INDEX index_left = factorToIndexSorted[ std::get<0>(rel) ];
+     const INDEX index_right = factorToIndexSorted[ std::get<1>(rel) ];
+     assert(index_left < index_right);
+     }
+   */
+}
+
+template<typename FMC>
+void LP<FMC>::set_ordering(const std::vector<INDEX>& f_sorted, std::vector<FactorTypeAdapter*>& ordering, std::vector<FactorTypeAdapter*>& update_ordering)
+{
   std::vector<FactorTypeAdapter*> fSorted;
   fSorted.reserve(f_.size());
   for(INDEX i=0; i<f_sorted.size(); i++) {
@@ -768,17 +978,6 @@ void LP<FMC>::SortFactors(
       update_ordering.push_back(f);
     }
   }
-  // check whether sorting was successful
-  /*
-     std::map<FactorTypeAdapter*, INDEX> factorToIndexSorted;
-     std::map<INDEX, FactorTypeAdapter*> indexToFactorSorted;
-     BuildIndexMaps(ordering.begin(), ordering.end(), factorToIndexSorted, indexToFactorSorted);
-     for(auto rel : factor_rel) {
-     const INDEX index_left = factorToIndexSorted[ std::get<0>(rel) ];
-     const INDEX index_right = factorToIndexSorted[ std::get<1>(rel) ];
-     assert(index_left < index_right);
-     }
-   */
 }
 
 template<typename FMC>
@@ -787,19 +986,20 @@ void LP<FMC>::SortFactors()
   if(ordering_valid_) { return; }
   ordering_valid_ = true;
 
-#pragma omp parallel sections
-  {
-#pragma omp section
-    SortFactors(forward_pass_factor_rel_, forwardOrdering_, forwardUpdateOrdering_, f_forward_sorted_);
-#pragma omp section
-    SortFactors(backward_pass_factor_rel_, backwardOrdering_, backwardUpdateOrdering_, f_backward_sorted_);
-  }
+  get_executor().run(2, [this](const INDEX t) {
+    if(t == 0) {
+      SortFactors(forward_pass_factor_rel_, forwardOrdering_, forwardUpdateOrdering_, f_forward_sorted_);
+    } else {
+      SortFactors(backward_pass_factor_rel_, backwardOrdering_, backwardUpdateOrdering_, f_backward_sorted_);
+    }
+  });
 }
 
 
 #ifdef LP_MP_PARALLEL
 // a factor needs to be called with enabled synchronization only if one of its neighbots of distance 2 is updated by another thread
-  template<typename ITERATOR>
+template<typename FMC>
+template<typename ITERATOR>
 inline std::vector<bool> LP<FMC>::compute_synchronization(ITERATOR factor_begin, ITERATOR factor_end)
 {
   const INDEX n = std::distance(factor_begin, factor_end);
@@ -807,25 +1007,21 @@ inline std::vector<bool> LP<FMC>::compute_synchronization(ITERATOR factor_begin,
 
   std::vector<INDEX> thread_number(this->f_.size(), std::numeric_limits<INDEX>::max());
   std::cout << "compute " << n << " factors to be synchronized\n";
-#pragma omp parallel num_threads(num_lp_threads_arg_.getValue())
-  {
-    assert(num_lp_threads_arg_.getValue() == omp_get_num_threads());
-    const int nthreads = num_lp_threads_arg_.getValue();
-    const int ithread = omp_get_thread_num();
-    assert(0 <= ithread && ithread < num_lp_threads_arg_.getValue());
-    const int start = (ithread*n)/nthreads;
-    const int finish = ((ithread+1)*n)/nthreads;
+  const INDEX nthreads = get_executor().no_threads();
+  get_executor().run(nthreads, [&](const INDEX ithread) {
+    const INDEX start = (ithread*n)/nthreads;
+    const INDEX finish = ((ithread+1)*n)/nthreads;
 
     for(INDEX i=start; i<finish; ++i) {
       const INDEX factor_number = factor_address_to_index_[*(factor_begin+i)];
       thread_number[factor_number] = ithread;
     }
-  }
+  });
 
   // check for every factor all its neighbors and see whether more than two possible threads access it.
-  std::vector<bool> conflict_factor(this->f_.size(), false);
-#pragma omp parallel for
-  for(INDEX i=0; i<this->f_.size(); ++i) {
+  // char instead of bool, since neighbouring elements of std::vector<bool> cannot be written concurrently
+  std::vector<char> conflict_factor(this->f_.size(), false);
+  parallel_for(get_executor(), this->f_.size(), [&](const INDEX i) {
     auto *f = f_[i];
     INDEX prev_adjacent_thread_number = thread_number[i];
     for(auto m_it=f->begin(); m_it!=f->end(); ++m_it) {
@@ -838,25 +1034,25 @@ inline std::vector<bool> LP<FMC>::compute_synchronization(ITERATOR factor_begin,
         prev_adjacent_thread_number = adjacent_thread_number;
       }
     }
-  }
+  });
   std::cout << "# conflict factors = " << std::count(conflict_factor.begin(), conflict_factor.end(), true) << "\n";
 
   // if a factor is adjacent to a conflict factor or is itself one, then it needs to be synchronized
-  std::vector<bool> synchronize(n);
-#pragma omp parallel for
-  for(INDEX i=0; i<n; ++i) {
+  std::vector<char> synchronize_factor(n, false);
+  parallel_for(get_executor(), n, [&](const INDEX i) {
     auto* f = *(factor_begin+i);
     const INDEX factor_number = factor_address_to_index_[f];
     for(auto m_it=f->begin(); m_it!=f->end(); ++m_it) {
       const INDEX adjacent_factor_number = factor_address_to_index_[m_it.GetConnectedFactor()];
       if(conflict_factor[adjacent_factor_number]) {
-        synchronize[i] = true;
+        synchronize_factor[i] = true;
       }
     }
     if(conflict_factor[factor_number]) {
-      synchronize[i] = true;
+      synchronize_factor[i] = true;
     }
-  }
+  });
+  std::vector<bool> synchronize(synchronize_factor.begin(), synchronize_factor.end());
 
   if(debug()) {
     std::cout << std::count(synchronize.begin(), synchronize.end(), true) << ";" << synchronize.size() << "\n";
@@ -880,6 +1076,8 @@ inline void LP<FMC>::ComputePass(const INDEX iteration)
        compute_overlapping_partition_pass(inner_iteration_number_arg_.getValue());
        ComputeForwardPass();
        ComputeBackwardPass();
+   } else if(reparametrization_type_ == reparametrization_type::priority) {
+       compute_priority_pass();
    } else {
        ComputeForwardPass();
        ComputeBackwardPass();
@@ -893,9 +1091,20 @@ void LP<FMC>::ComputeForwardPass()
   assert(omega.forward.size() == omega.receive_mask_forward.size());
   assert(omega.backward.size() == omega.receive_mask_backward.size());
 #ifdef LP_MP_PARALLEL
-  ComputePassSynchronized(forwardUpdateOrdering_.begin(), forwardUpdateOrdering_.end(), omega.forward.begin(), omega.forward.end(), synchronize_forward_.begin(), synchronize_forward_.end()); 
+  if(parallel_schedule_ == parallel_schedule_type::coloring) {
+    ComputePassColored(forwardUpdateOrdering_.begin(), omega.forward.begin(), omega.receive_mask_forward.begin(), color_classes_forward_, false, forward_schedule_);
+  } else {
+    ComputePassSynchronized(forwardUpdateOrdering_.begin(), forwardUpdateOrdering_.end(), omega.forward.begin(), omega.forward.end(), omega.receive_mask_forward.begin(), synchronize_forward_.begin(), synchronize_forward_.end(), forward_schedule_); 
+  }
 #else
-  ComputePass(forwardUpdateOrdering_.begin(), forwardUpdateOrdering_.end(), omega.forward.begin(), omega.receive_mask_forward.begin()); 
+  if(skip_converged_factors_arg_.getValue()) {
+    compute_skip_state();
+    ComputePassSkipping(forwardUpdateOrdering_, forward_update_index_, omega.forward.begin(), omega.receive_mask_forward.begin());
+  } else if(batched_factor_update_arg_.getValue()) {
+    ComputePassBatched(forward_factor_batches_, omega.forward.begin(), omega.receive_mask_forward.begin(), false);
+  } else {
+    ComputePass(forwardUpdateOrdering_.begin(), forwardUpdateOrdering_.end(), omega.forward.begin(), omega.receive_mask_forward.begin()); 
+  }
 #endif
 }
 
@@ -904,9 +1113,20 @@ void LP<FMC>::ComputeBackwardPass()
 {
   const auto omega = get_omega();
 #ifdef LP_MP_PARALLEL
-  ComputePassSynchronized(backwardUpdateOrdering_.begin(), backwardUpdateOrdering_.end(), omega.backward.begin(), omega.backward.end(), synchronize_backward_.begin(), synchronize_backward_.end()); 
+  if(parallel_schedule_ == parallel_schedule_type::coloring) {
+    ComputePassColored(backwardUpdateOrdering_.begin(), omega.backward.begin(), omega.receive_mask_backward.begin(), color_classes_backward_, true, backward_schedule_);
+  } else {
+    ComputePassSynchronized(backwardUpdateOrdering_.begin(), backwardUpdateOrdering_.end(), omega.backward.begin(), omega.backward.end(), omega.receive_mask_backward.begin(), synchronize_backward_.begin(), synchronize_backward_.end(), backward_schedule_); 
+  }
 #else
-  ComputePass(backwardUpdateOrdering_.begin(), backwardUpdateOrdering_.end(), omega.backward.begin(), omega.receive_mask_backward.begin());
+  if(skip_converged_factors_arg_.getValue()) {
+    compute_skip_state();
+    ComputePassSkipping(backwardUpdateOrdering_, backward_update_index_, omega.backward.begin(), omega.receive_mask_backward.begin());
+  } else if(batched_factor_update_arg_.getValue()) {
+    ComputePassBatched(backward_factor_batches_, omega.backward.begin(), omega.receive_mask_backward.begin(), true);
+  } else {
+    ComputePass(backwardUpdateOrdering_.begin(), backwardUpdateOrdering_.end(), omega.backward.begin(), omega.receive_mask_backward.begin());
+  }
 #endif
 }
 
@@ -937,14 +1157,51 @@ void LP<FMC>::ComputePassAndPrimal(const INDEX iteration)
 {
   ComputeForwardPassAndPrimal(iteration);
   ComputeBackwardPassAndPrimal(iteration);
+  skip_state_valid_ = false; // all factors were updated
+}
+
+// factors and their messages live in memory pools in the order they were added, only the dual memory held outside of the factor containers (e.g. in vector) can be moved.
+// The block arena is a stack, hence consecutively reallocated factors are adjacent in memory. The previous memory is not reused.
+template<typename FMC>
+void LP<FMC>::relocate_factors()
+{
+  SortFactors();
+  std::vector<INDEX> order;
+  if(relocate_factors_arg_.getValue() == "update") {
+    // factors not updated in passes come last
+    std::vector<char> placed(f_.size(), 0);
+    for(auto* f : forwardUpdateOrdering_) {
+      const INDEX i = factor_address_to_index_[f];
+      order.push_back(i);
+      placed[i] = 1;
+    }
+    for(INDEX i=0; i<f_.size(); ++i) {
+      if(!placed[i]) { order.push_back(i); }
+    }
+  } else if(relocate_factors_arg_.getValue() == "rcm") {
+    order = reverse_cuthill_mckee(factor_adjacency());
+  } else {
+    throw std::runtime_error("factor relocation not supported: " + relocate_factors_arg_.getValue());
+  }
+  assert(order.size() == f_.size());
+
+  for(const INDEX i : order) {
+    f_[i]->relocate_dual();
+  }
+  if(diagnostics()) {
+    std::cout << "relocated dual memory of " << order.size() << " factors in " << relocate_factors_arg_.getValue() << " order\n";
+  }
 }
 
 #ifdef LP_MP_PARALLEL
-template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR, typename SYNCHRONIZATION_ITERATOR>
+template<typename FMC>
+template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR, typename RECEIVE_MASK_ITERATOR, typename SYNCHRONIZATION_ITERATOR>
 void LP<FMC>::ComputePassSynchronized(
        FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorItEnd, 
        OMEGA_ITERATOR omega_begin, OMEGA_ITERATOR omega_end,
-       SYNCHRONIZATION_ITERATOR synchronization_begin, SYNCHRONIZATION_ITERATOR synchronization_end)
+       RECEIVE_MASK_ITERATOR receive_begin,
+       SYNCHRONIZATION_ITERATOR synchronization_begin, SYNCHRONIZATION_ITERATOR synchronization_end,
+       work_stealing_schedule& schedule)
 
 {
   const INDEX n = std::distance(factorIt, factorItEnd);
@@ -955,26 +1212,156 @@ void LP<FMC>::ComputePassSynchronized(
   //for(INDEX i=0; i<n; ++i) {
   //  std::cout << i << ": " << (*(synchronization_begin + i) == true ? "true" : "false") << "\n";
   //}
-#pragma omp parallel num_threads(num_lp_threads_arg_.getValue())
-  {
-    assert(num_lp_threads_arg_.getValue() == omp_get_num_threads());
-    const int nthreads = num_lp_threads_arg_.getValue();
-    const int ithread = omp_get_thread_num();
-    assert(0 <= ithread && ithread < num_lp_threads_arg_.getValue());
-    const int start = (ithread*n)/nthreads;
-    const int finish = ((ithread+1)*n)/nthreads;
 
-    for(INDEX i=start; i<finish; ++i) {
-      auto* f = *(factorIt + i); 
-      if(*(synchronization_begin+i)) {
-        f->UpdateFactorSynchronized(*(omega_begin + i));
-        //f->UpdateFactor(*(omega_begin + i));
-      } else {
-        f->UpdateFactor(*(omega_begin + i));
-        //f->UpdateFactorSynchronized(*(omegaIt + i));
+  // synchronization flags are computed w.r.t. the static distribution of factors onto threads.
+  // Stolen chunks may be updated concurrently with arbitrary neighbours, hence all factor updates are synchronized under work stealing.
+  const bool work_stealing = parallel_schedule_ == parallel_schedule_type::work_stealing;
+  const INDEX nthreads = get_executor().no_threads();
+  schedule.init(n, nthreads, schedule_chunk_size_arg_.getValue()); // for the static schedule only the time measurement is used
+
+  get_executor().run(nthreads, [&](const INDEX ithread) {
+    if(work_stealing) {
+      schedule.run(ithread, [&](const INDEX begin, const INDEX end) {
+        for(INDEX i=begin; i<end; ++i) {
+          (*(factorIt + i))->UpdateFactorSynchronized(*(omega_begin + i));
+        }
+      });
+    } else {
+      const INDEX start = (ithread*n)/nthreads;
+      const INDEX finish = ((ithread+1)*n)/nthreads;
+      const auto t0 = std::chrono::steady_clock::now();
+      for(INDEX i=start; i<finish; ++i) {
+        auto* f = *(factorIt + i); 
+        if(*(synchronization_begin+i)) {
+          f->UpdateFactorSynchronized(*(omega_begin + i));
+        } else {
+          f->UpdateFactor(*(omega_begin + i), *(receive_begin + i));
+        }
       }
+      schedule.add_busy_time(ithread, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
     }
-  } 
+  });
+  schedule.finish();
+}
+
+// color classes are ordered by the position of their first factor in the forward update ordering.
+// The forward pass goes through the classes in this order, the backward pass in reverse, so that the update order approximately follows the pass direction.
+template<typename FMC>
+void LP<FMC>::compute_coloring()
+{
+  assert(ordering_valid_);
+  if(coloring_valid_) { return; }
+  coloring_valid_ = true;
+
+  const auto& adjacency = factor_adjacency();
+
+  std::vector<INDEX> order;
+  order.reserve(forwardUpdateOrdering_.size());
+  for(auto* f : forwardUpdateOrdering_) { order.push_back(factor_address_to_index_[f]); }
+  const auto color = distance_two_coloring(adjacency, order.begin(), order.end());
+
+  // colors are assigned greedily in forward order, hence color c first appears before color c+1.
+  INDEX no_colors = 0;
+  for(const INDEX i : order) { no_colors = std::max(no_colors, color[i]+1); }
+  auto compute_classes = [&](const std::vector<FactorTypeAdapter*>& update_ordering, two_dim_variable_array<INDEX>& color_classes) {
+    std::vector<INDEX> class_size(no_colors, 0);
+    for(auto* f : update_ordering) { ++class_size[color[factor_address_to_index_[f]]]; }
+    color_classes.resize(class_size.begin(), class_size.end());
+    std::fill(class_size.begin(), class_size.end(), 0);
+    for(INDEX i=0; i<update_ordering.size(); ++i) {
+      const INDEX c = color[factor_address_to_index_[update_ordering[i]]];
+      color_classes(c, class_size[c]++) = i;
+    }
+  };
+  compute_classes(forwardUpdateOrdering_, color_classes_forward_);
+  compute_classes(backwardUpdateOrdering_, color_classes_backward_);
+
+  if(diagnostics()) {
+    std::cout << "colored " << order.size() << " factors with " << no_colors << " colors for lock-free parallel message passing\n";
+  }
+}
+
+template<typename FMC>
+template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR, typename RECEIVE_MASK_ITERATOR>
+void LP<FMC>::ComputePassColored(FACTOR_ITERATOR factor_begin, OMEGA_ITERATOR omega_begin, RECEIVE_MASK_ITERATOR receive_begin, const two_dim_variable_array<INDEX>& color_classes, const bool reverse_color_order, work_stealing_schedule& schedule)
+{
+  const INDEX nthreads = get_executor().no_threads();
+  for(INDEX k=0; k<color_classes.size(); ++k) {
+    const auto color_class = color_classes[reverse_color_order ? color_classes.size()-1-k : k];
+    schedule.init(color_class.size(), nthreads, schedule_chunk_size_arg_.getValue());
+    get_executor().run(nthreads, [&](const INDEX ithread) {
+      schedule.run(ithread, [&](const INDEX begin, const INDEX end) {
+        for(INDEX j=begin; j<end; ++j) {
+          const INDEX i = color_class[j];
+          (*(factor_begin + i))->UpdateFactor(*(omega_begin + i), *(receive_begin + i));
+        }
+      });
+    });
+    schedule.finish();
+  }
+}
+
+template<typename FMC>
+void LP<FMC>::init_executor()
+{
+  if(executor_) { return; }
+  if(executor_arg_.getValue() == "openmp") {
+    executor_ = std::make_shared<openmp_executor>(num_lp_threads_arg_.getValue());
+  } else if(executor_arg_.getValue() == "thread_pool") {
+    executor_ = std::make_shared<thread_pool_executor>(num_lp_threads_arg_.getValue());
+  } else {
+    throw std::runtime_error("executor not supported: " + executor_arg_.getValue());
+  }
+}
+
+// each thread is pinned to a node and migrates the pages of its static block of forwardUpdateOrdering_ there with one move_pages call.
+// Threads t and nthreads-1-t share a node, so the static blocks of the backward pass are mostly on the node of the thread updating them as well, see numa_thread_node.
+// The openmp executor runs task t on OpenMP thread t and OpenMP keeps its threads alive between parallel regions with the same number of threads, so the pinning persists for the passes.
+template<typename FMC>
+void LP<FMC>::place_factors_numa()
+{
+  const INDEX n = forwardUpdateOrdering_.size();
+  const INDEX nthreads = get_executor().no_threads();
+  if(numa_no_nodes() > 1) {
+    numa_arenas_active = true;
+  }
+  std::vector<INDEX> forward_node(f_.size());
+  get_executor().run(nthreads, [&](const INDEX ithread) {
+    const INDEX node = numa_pin_thread(ithread, nthreads);
+    stack_allocator_index = node % no_stack_allocators;
+    if(numa_no_nodes() == 1) { return; }
+    std::vector<void*> pages;
+    for(INDEX i=(ithread*n)/nthreads; i<((ithread+1)*n)/nthreads; ++i) {
+      forwardUpdateOrdering_[i]->numa_pages(pages);
+      forward_node[factor_address_to_index_.find(forwardUpdateOrdering_[i])->second] = node;
+    }
+    numa_move_pages(pages, node);
+  });
+  if(diagnostics()) {
+    INDEX backward_local = 0;
+    const INDEX no_nodes = numa_no_nodes();
+    for(INDEX t=0; t<nthreads; ++t) {
+      for(INDEX i=(t*n)/nthreads; i<((t+1)*n)/nthreads; ++i) {
+        const INDEX node = numa_thread_node(t, nthreads, no_nodes);
+        if(no_nodes == 1 || forward_node[factor_address_to_index_.find(backwardUpdateOrdering_[i])->second] == node) { ++backward_local; }
+      }
+    }
+    std::cout << "distributed " << n << " factors onto " << std::min(no_nodes, nthreads) << " numa nodes, " << backward_local << " of them are local in the backward pass as well\n";
+  }
+}
+
+template<typename FMC>
+void LP<FMC>::print_schedule_statistics(const work_stealing_schedule& s, const std::string& pass_name) const
+{
+  std::cout << "thread statistics for " << pass_name << " passes:\n";
+  for(INDEX t=0; t<s.statistics().size(); ++t) {
+    const auto& stat = s.statistics()[t];
+    std::cout << "  thread " << t << ": busy = " << stat.busy_time << "s, idle = " << stat.idle_time << "s";
+    if(parallel_schedule_ == parallel_schedule_type::work_stealing) {
+      std::cout << ", chunks = " << stat.chunks_processed << ", stolen = " << stat.chunks_stolen;
+    }
+    std::cout << "\n";
+  }
 }
 #endif
 
@@ -985,7 +1372,8 @@ void LP<FMC>::ComputePass(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factor
     //assert(std::distance(factorItEnd, factorIt) == std::distance(omegaIt, omegaItEnd));
     const INDEX n = std::distance(factorIt, factorItEnd);
     //#pragma omp parallel for schedule(static)
-    if(reparametrization_type_ == reparametrization_type::shared || reparametrization_type_ == reparametrization_type::partition || reparametrization_type_ == reparametrization_type::overlapping_partition) {
+    // priority reparametrization sends messages like shared outside of compute_priority_pass, e.g. in the rounding passes of solvers
+    if(reparametrization_type_ == reparametrization_type::shared || reparametrization_type_ == reparametrization_type::partition || reparametrization_type_ == reparametrization_type::overlapping_partition || reparametrization_type_ == reparametrization_type::priority) {
         for(INDEX i=0; i<n; ++i) {
             auto* f = *(factorIt + i);
             f->UpdateFactor(*(omegaIt + i), *(receive_it + i));
@@ -1066,14 +1454,10 @@ inline void LP<FMC>::ComputeDampedUniformWeights()
 template<typename FMC>
 inline bool LP<FMC>::CheckPrimalConsistency() const
 {
-   volatile bool consistent=true; // or use std::atomic<bool>?
-
-    for_each_tuple(factors_, [&consistent,this](auto& v) {
-            for(auto* f : v) {
-                if(!consistent) continue;
-                if(!f->check_primal_consistency()) {
-                    consistent = false;
-                }
+    bool consistent = true;
+    for_each_tuple(factors_, [this,&consistent](auto& v) {
+            if(consistent) {
+                consistent = parallel_all_of(get_executor(), v.size(), [&v](const std::size_t i) { return v[i]->check_primal_consistency(); });
             }
     });
 
@@ -1089,10 +1473,9 @@ void LP<FMC>::ComputeAnisotropicWeights2(
       weight_array& omega, receive_array& receive_mask)
 {
    std::vector<INDEX> f_sorted_inverse(std::distance(factor_sort_begin, factor_sort_end)); // factor index in order they were added to sorted order
-#pragma omp parallel for
-   for(INDEX i=0; i<std::distance(factor_sort_begin, factor_sort_end); ++i) {
+   parallel_for(get_executor(), f_sorted_inverse.size(), [&](const INDEX i) {
       f_sorted_inverse[ factor_sort_begin[i] ] = i;
-   }
+   });
 
    assert(std::distance(factorIt,factorEndIt) == f_.size());
    assert(std::distance(factor_sort_begin, factor_sort_end) == f_.size());
@@ -1468,13 +1851,12 @@ inline void LP<FMC>::ComputeMixedWeights(
    omega = omega_anisotropic;
    
    assert(omega_damped_uniform.size() == omega.size());
-#pragma omp parallel for
-   for(INDEX i=0; i<omega.size(); ++i) {
+   parallel_for(get_executor(), omega.size(), [&](const INDEX i) {
       assert(omega_damped_uniform[i].size() == omega[i].size());
       for(INDEX j=0; j<omega[i].size(); ++j) {
          omega[i][j] = 0.5*(omega[i][j] + omega_damped_uniform[i][j]);
       }
-   }
+   });
 }
 
 template<typename FMC>
@@ -1505,15 +1887,559 @@ void LP<FMC>::compute_full_receive_mask(FACTOR_ITERATOR factor_begin, FACTOR_ITE
 }
 
 template<typename FMC>
-double LP<FMC>::LowerBound() const
+const two_dim_variable_array<INDEX>& LP<FMC>::factor_adjacency()
 {
-    double lb = constant_;
-    for_each_tuple(factors_, [&lb,this](auto& v) {
-            for(auto* f : v) {
-                lb += f->LowerBound();
-                assert(std::isfinite(lb));
+  if(factor_adjacency_valid_) { return factor_adjacency_; }
+  factor_adjacency_valid_ = true;
+
+  std::vector<INDEX> no_adjacent(f_.size(), 0);
+  for(const auto& m : m_) {
+    ++no_adjacent[factor_address_to_index_[m.left]];
+    ++no_adjacent[factor_address_to_index_[m.right]];
+  }
+  factor_adjacency_.resize(no_adjacent.begin(), no_adjacent.end());
+  std::fill(no_adjacent.begin(), no_adjacent.end(), 0);
+  for(const auto& m : m_) {
+    const INDEX l = factor_address_to_index_[m.left];
+    const INDEX r = factor_address_to_index_[m.right];
+    factor_adjacency_(l, no_adjacent[l]++) = r;
+    factor_adjacency_(r, no_adjacent[r]++) = l;
+  }
+  return factor_adjacency_;
+}
+
+template<typename FMC>
+void LP<FMC>::compute_priority_schedule()
+{
+  assert(ordering_valid_);
+  if(priority_schedule_valid_) { return; }
+  priority_schedule_valid_ = true;
+
+  const auto& adjacency = factor_adjacency();
+  priority_position_.assign(f_.size(), std::numeric_limits<INDEX>::max());
+  for(INDEX i=0; i<forwardUpdateOrdering_.size(); ++i) {
+    priority_position_[factor_address_to_index_[forwardUpdateOrdering_[i]]] = i;
+  }
+
+  std::vector<INDEX> no_update_neighbours;
+  for(auto* f : forwardUpdateOrdering_) {
+    const auto neighbours = adjacency[factor_address_to_index_[f]];
+    no_update_neighbours.push_back(std::count_if(neighbours.begin(), neighbours.end(), [&](const INDEX j) { return priority_position_[j] != std::numeric_limits<INDEX>::max(); }));
+  }
+  priority_update_neighbours_.resize(no_update_neighbours.begin(), no_update_neighbours.end());
+  for(INDEX i=0; i<forwardUpdateOrdering_.size(); ++i) {
+    const auto neighbours = adjacency[factor_address_to_index_[forwardUpdateOrdering_[i]]];
+    INDEX l = 0;
+    for(const INDEX j : neighbours) {
+      if(priority_position_[j] != std::numeric_limits<INDEX>::max()) {
+        priority_update_neighbours_(i, l++) = priority_position_[j];
+      }
+    }
+  }
+
+  for(auto* f : f_) { f->track_received_change(true); }
+  // every factor is updated once, in forward order, before priorities are known
+  priority_queue_.init(forwardUpdateOrdering_.size(), std::numeric_limits<REAL>::infinity(), priority_threshold_arg_.getValue());
+}
+
+template<typename FMC>
+void LP<FMC>::compute_priority_pass()
+{
+  const auto omega = get_omega();
+  compute_priority_schedule();
+
+  // as many updates as in a forward and a backward pass
+  const INDEX max_updates = 2*forwardUpdateOrdering_.size();
+  INDEX no_updates = 0;
+  for(; no_updates<max_updates && !priority_queue_.empty(); ++no_updates) {
+    const INDEX i = priority_queue_.top();
+    priority_queue_.pop();
+    forwardUpdateOrdering_[i]->UpdateFactor(omega.forward[i], omega.receive_mask_forward[i]);
+    forwardUpdateOrdering_[i]->reset_received_change();
+    // neighbours accumulated the messages sent by the update, factors not updated yet keep infinite priority
+    for(const INDEX j : priority_update_neighbours_[i]) {
+      priority_queue_.set(j, std::max(priority_queue_.priority(j), forwardUpdateOrdering_[j]->received_change()));
+    }
+  }
+
+  if(diagnostics()) {
+    std::cout << "priority pass: " << no_updates << " factor updates, " << priority_queue_.size() << " of " << forwardUpdateOrdering_.size() << " factors not converged\n";
+  }
+}
+
+template<typename FMC>
+void LP<FMC>::compute_skip_state()
+{
+  assert(ordering_valid_);
+  if(skip_state_valid_ && skip_repam_mode_ == repamMode_) { return; }
+  if(!skip_state_valid_) {
+    forward_update_index_.clear();
+    for(auto* f : forwardUpdateOrdering_) { forward_update_index_.push_back(factor_address_to_index_[f]); }
+    backward_update_index_.clear();
+    for(auto* f : backwardUpdateOrdering_) { backward_update_index_.push_back(factor_address_to_index_[f]); }
+  }
+  skip_state_valid_ = true;
+  skip_repam_mode_ = repamMode_;
+  factor_active_.assign(f_.size(), true);
+  for(auto* f : f_) { f->track_received_change(true); }
+}
+
+template<typename FMC>
+template<typename OMEGA_ITERATOR, typename RECEIVE_MASK_ITERATOR>
+void LP<FMC>::ComputePassSkipping(const std::vector<FactorTypeAdapter*>& update_ordering, const std::vector<INDEX>& update_index, OMEGA_ITERATOR omega_it, RECEIVE_MASK_ITERATOR receive_it)
+{
+  assert(update_ordering.size() == update_index.size());
+  const REAL tolerance = skip_tolerance_arg_.getValue();
+
+  for(INDEX i=0; i<update_ordering.size(); ++i) {
+    const INDEX k = update_index[i];
+    auto* f = update_ordering[i];
+    // messages sent by neighbours since the last update of f were accumulated while they reparametrized f
+    if(!factor_active_[k] && !(f->received_change() > tolerance)) {
+      ++update_statistics_.skipped;
+      continue;
+    }
+    ++update_statistics_.updated;
+    factor_active_[k] = false;
+
+    if(reparametrization_type_ == reparametrization_type::residual) {
+      f->update_factor_residual(*(omega_it + i), *(receive_it + i));
+    } else if(reparametrization_type_ == reparametrization_type::adaptive) {
+      f->update_factor_adaptive(*(omega_it + i), *(receive_it + i));
+    } else { // shared, partition, overlapping_partition and priority
+      f->UpdateFactor(*(omega_it + i), *(receive_it + i));
+    }
+    f->reset_received_change();
+  }
+}
+
+template<typename FMC>
+void LP<FMC>::compute_factor_batches()
+{
+  assert(ordering_valid_);
+  if(factor_batches_valid_) { return; }
+  factor_batches_valid_ = true;
+  compute_factor_batches(forwardUpdateOrdering_, forward_factor_batches_);
+  compute_factor_batches(backwardUpdateOrdering_, backward_factor_batches_);
+}
+
+template<typename FMC>
+void LP<FMC>::compute_factor_batches(const std::vector<FactorTypeAdapter*>& update_ordering, factor_batch_storage_type& batches)
+{
+  std::vector<INDEX> position(f_.size(), std::numeric_limits<INDEX>::max());
+  for(INDEX i=0; i<update_ordering.size(); ++i) {
+    position[factor_address_to_index_[update_ordering[i]]] = i;
+  }
+
+  for_each_tuple(batches, [&](auto& batch) {
+      using factor_container_type = std::remove_pointer_t<typename std::decay_t<decltype(batch)>::value_type::first_type>;
+      constexpr auto n = factor_tuple_index<factor_container_type>();
+      batch.clear();
+      for(auto* f : std::get<n>(factors_)) {
+        const INDEX i = position[factor_address_to_index_[f]];
+        if(i != std::numeric_limits<INDEX>::max()) {
+          batch.push_back({f,i});
+        }
+      }
+      // keep relative order of the update ordering within each factor type
+      std::sort(batch.begin(), batch.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+  });
+}
+
+template<typename FMC>
+template<typename FACTOR_BATCHES, typename OMEGA_ITERATOR, typename RECEIVE_MASK_ITERATOR>
+void LP<FMC>::ComputePassBatched(FACTOR_BATCHES& batches, OMEGA_ITERATOR omega_begin, RECEIVE_MASK_ITERATOR receive_begin, const bool reverse_types)
+{
+  // f has concrete factor container type and the update functions are final, hence there is no virtual call inside the loops.
+  auto update_batch = [&](auto& batch) {
+      if(reparametrization_type_ == reparametrization_type::residual) {
+        for(auto [f,i] : batch) {
+          f->update_factor_residual(*(omega_begin + i), *(receive_begin + i));
+        }
+      } else if(reparametrization_type_ == reparametrization_type::adaptive) {
+        for(auto [f,i] : batch) {
+          f->update_factor_adaptive(*(omega_begin + i), *(receive_begin + i));
+        }
+      } else { // shared, partition, overlapping_partition and priority
+        for(auto [f,i] : batch) {
+          f->UpdateFactor(*(omega_begin + i), *(receive_begin + i));
+        }
+      }
+  };
+  if(reverse_types) {
+    for_each_tuple_reverse(batches, update_batch);
+  } else {
+    for_each_tuple(batches, update_batch);
+  }
+}
+
+template<typename FMC>
+std::vector<std::uint32_t> LP<FMC>::factor_types() const
+{
+  std::vector<std::uint32_t> types(f_.size());
+  for_each_tuple(factors_, [&](auto& v) {
+      using factor_container_type = typename std::remove_pointer<typename std::remove_reference<decltype(v)>::type::value_type>::type;
+      constexpr auto type = factor_tuple_index<factor_container_type>();
+      for(auto* f : v) {
+        types[factor_address_to_index_.find(f)->second] = type;
+      }
+  });
+  return types;
+}
+
+// messages of m_ and of the per type lists in messages_ were both added in the same order, hence the next unmatched message of some type connects the same factors
+template<typename FMC>
+std::vector<std::array<INDEX,2>> LP<FMC>::message_types() const
+{
+  std::vector<std::array<INDEX,2>> types;
+  types.reserve(m_.size());
+  std::array<INDEX, meta::size<typename FMC::MessageList>::value> next;
+  next.fill(0);
+  for(const auto& m : m_) {
+    bool found = false;
+    for_each_tuple(messages_, [&](auto& v) {
+        using message_container_type = typename std::remove_pointer<typename std::remove_reference<decltype(v)>::type::value_type>::type;
+        constexpr auto type = message_tuple_index<message_container_type>();
+        if(!found && next[type] < v.size() && v[next[type]]->GetLeftFactor() == m.left && v[next[type]]->GetRightFactor() == m.right) {
+          types.push_back({type, next[type]++});
+          found = true;
+        }
+    });
+    assert(found);
+  }
+  return types;
+}
+
+template<typename FMC>
+void LP<FMC>::save_model(const std::string& filename)
+{
+  SortFactors();
+  const auto types = factor_types();
+  const auto msg_types = message_types();
+
+  // construction records of factors in the order of f_, followed by those of message operations in the order of m_
+  auto serialize_constructions = [&](auto& ar) {
+    for(INDEX i=0; i<f_.size(); ++i) {
+      for_each_tuple(factors_, [&](auto& v) {
+          using factor_container_type = typename std::remove_pointer<typename std::remove_reference<decltype(v)>::type::value_type>::type;
+          using factor_type = typename factor_container_type::FactorType;
+          if(types[i] == factor_tuple_index<factor_container_type>()) {
+            if constexpr(!std::is_default_constructible<factor_type>::value) {
+              throw std::runtime_error("factor type " + std::to_string(types[i]) + " is not default constructible and cannot be written into a model file");
+            } else {
+              serialize_construction(*static_cast<factor_container_type*>(f_[i])->GetFactor(), ar);
+            }
+          }
+      });
+    }
+    for(const auto& t : msg_types) {
+      for_each_tuple(messages_, [&](auto& v) {
+          using message_container_type = typename std::remove_pointer<typename std::remove_reference<decltype(v)>::type::value_type>::type;
+          using message_type = typename message_container_type::MessageType;
+          if(t[0] == message_tuple_index<message_container_type>()) {
+            if constexpr(!std::is_default_constructible<message_type>::value) {
+              throw std::runtime_error("message type " + std::to_string(t[0]) + " is not default constructible and cannot be written into a model file");
+            } else {
+              // save_archive and allocate_archive only read, serialize_construction is not const like serialize_dual
+              serialize_construction(const_cast<message_type&>(v[t[1]]->GetMessageOp()), ar);
             }
+          }
+      });
+    }
+  };
+
+  model_file_header h;
+  std::memcpy(h.magic, model_file_magic, sizeof(model_file_magic));
+  h.version = model_file_version;
+  h.real_size = sizeof(REAL);
+  h.fmc_hash = fmc_name_hash(FMC::name);
+  h.no_factors = f_.size();
+  h.no_messages = m_.size();
+  h.no_forward_relations = forward_pass_factor_rel_.size();
+  h.no_backward_relations = backward_pass_factor_rel_.size();
+  h.constant = constant_;
+  h.factor_types_offset = model_file_align(sizeof(model_file_header));
+  h.messages_offset = model_file_align(h.factor_types_offset + sizeof(std::uint32_t)*f_.size());
+  h.forward_relations_offset = model_file_align(h.messages_offset + 3*sizeof(std::uint64_t)*m_.size());
+  h.backward_relations_offset = model_file_align(h.forward_relations_offset + 2*sizeof(std::uint64_t)*h.no_forward_relations);
+  h.forward_ordering_offset = model_file_align(h.backward_relations_offset + 2*sizeof(std::uint64_t)*h.no_backward_relations);
+  h.backward_ordering_offset = model_file_align(h.forward_ordering_offset + sizeof(std::uint64_t)*f_.size());
+  h.construction_offset = model_file_align(h.backward_ordering_offset + sizeof(std::uint64_t)*f_.size());
+
+  allocate_archive construction_size_ar;
+  serialize_constructions(construction_size_ar);
+  h.construction_size = construction_size_ar.size();
+  serialization_archive construction(construction_size_ar);
+  save_archive construction_ar(construction);
+  serialize_constructions(construction_ar);
+
+  h.dual_offset = model_file_align(h.construction_offset + h.construction_size);
+  allocate_archive dual_size_ar;
+  for(auto* f : f_) { f->serialize_dual(dual_size_ar); }
+  h.dual_size = dual_size_ar.size();
+  serialization_archive dual(dual_size_ar);
+  save_archive dual_ar(dual);
+  for(auto* f : f_) { f->serialize_dual(dual_ar); }
+
+  std::ofstream file(filename, std::ios::binary);
+  if(!file) { throw std::runtime_error("could not open model file " + filename); }
+  auto write_at = [&](const std::uint64_t offset, const void* data, const std::size_t bytes) {
+    const std::uint64_t pos = file.tellp();
+    assert(pos <= offset);
+    const char zeros[model_file_alignment] = {};
+    file.write(zeros, offset - pos);
+    file.write(static_cast<const char*>(data), bytes);
+  };
+  auto write_indices_at = [&](const std::uint64_t offset, const std::vector<INDEX>& indices) {
+    const std::vector<std::uint64_t> v(indices.begin(), indices.end());
+    write_at(offset, v.data(), sizeof(std::uint64_t)*v.size());
+  };
+  auto relation_indices = [&](const std::vector<std::pair<FactorTypeAdapter*, FactorTypeAdapter*>>& relations) {
+    std::vector<INDEX> indices;
+    indices.reserve(2*relations.size());
+    for(const auto& r : relations) {
+      indices.push_back(factor_address_to_index_[r.first]);
+      indices.push_back(factor_address_to_index_[r.second]);
+    }
+    return indices;
+  };
+
+  file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+  write_at(h.factor_types_offset, types.data(), sizeof(std::uint32_t)*types.size());
+  std::vector<INDEX> messages;
+  messages.reserve(3*m_.size());
+  for(INDEX i=0; i<m_.size(); ++i) {
+    messages.push_back(msg_types[i][0]);
+    messages.push_back(factor_address_to_index_[m_[i].left]);
+    messages.push_back(factor_address_to_index_[m_[i].right]);
+  }
+  write_indices_at(h.messages_offset, messages);
+  write_indices_at(h.forward_relations_offset, relation_indices(forward_pass_factor_rel_));
+  write_indices_at(h.backward_relations_offset, relation_indices(backward_pass_factor_rel_));
+  write_indices_at(h.forward_ordering_offset, f_forward_sorted_);
+  write_indices_at(h.backward_ordering_offset, f_backward_sorted_);
+  write_at(h.construction_offset, construction.begin(), h.construction_size);
+  write_at(h.dual_offset, dual.begin(), h.dual_size);
+  if(!file) { throw std::runtime_error("could not write model file " + filename); }
+}
+
+template<typename FMC>
+void LP<FMC>::load_model(const std::string& filename)
+{
+  if(!f_.empty()) {
+    throw std::runtime_error("model file " + filename + " can only be loaded into an empty problem");
+  }
+  mapped_model_file file(filename);
+  const auto& h = file.header();
+  if(h.fmc_hash != fmc_name_hash(FMC::name)) {
+    throw std::runtime_error("model file " + filename + " was written for another problem type");
+  }
+  auto check_factor = [&](const std::uint64_t i) {
+    if(i >= h.no_factors) { throw std::runtime_error("model file " + filename + " refers to factor " + std::to_string(i) + " out of range"); }
+    return f_[i];
+  };
+
+  model_file_archive construction(file.section<char>(h.construction_offset), h.construction_size);
+  load_archive construction_ar(construction);
+
+  const auto* types = file.section<std::uint32_t>(h.factor_types_offset);
+  f_.reserve(h.no_factors);
+  for(INDEX i=0; i<h.no_factors; ++i) {
+    bool constructed = false;
+    for_each_tuple(factors_, [&](auto& v) {
+        using factor_container_type = typename std::remove_pointer<typename std::remove_reference<decltype(v)>::type::value_type>::type;
+        using factor_type = typename factor_container_type::FactorType;
+        if(types[i] == factor_tuple_index<factor_container_type>()) {
+          if constexpr(!std::is_default_constructible<factor_type>::value) {
+            throw std::runtime_error("factor type " + std::to_string(types[i]) + " is not default constructible and cannot be read from a model file");
+          } else {
+            auto* f = this->template add_factor<factor_container_type>();
+            serialize_construction(*f->GetFactor(), construction_ar);
+            constructed = true;
+          }
+        }
+    });
+    if(!constructed) { throw std::runtime_error("model file " + filename + " contains unknown factor type " + std::to_string(types[i])); }
+  }
+
+  const auto* messages = file.section<std::uint64_t>(h.messages_offset);
+  for(INDEX i=0; i<h.no_messages; ++i) {
+    auto* left = check_factor(messages[3*i+1]);
+    auto* right = check_factor(messages[3*i+2]);
+    bool constructed = false;
+    for_each_tuple(messages_, [&](auto& v) {
+        using message_container_type = typename std::remove_pointer<typename std::remove_reference<decltype(v)>::type::value_type>::type;
+        using message_type = typename message_container_type::MessageType;
+        using left_factor_type = typename message_container_type::LeftFactorContainer;
+        using right_factor_type = typename message_container_type::RightFactorContainer;
+        if(messages[3*i] == message_tuple_index<message_container_type>()) {
+          if constexpr(!std::is_default_constructible<message_type>::value) {
+            throw std::runtime_error("message type " + std::to_string(messages[3*i]) + " is not default constructible and cannot be read from a model file");
+          } else {
+            auto* l = dynamic_cast<left_factor_type*>(left);
+            auto* r = dynamic_cast<right_factor_type*>(right);
+            if(l == nullptr || r == nullptr) { throw std::runtime_error("message " + std::to_string(i) + " in model file " + filename + " connects factors of wrong type"); }
+            message_type msg_op;
+            serialize_construction(msg_op, construction_ar);
+            this->template add_message<message_container_type>(l, r, msg_op);
+            constructed = true;
+          }
+        }
+    });
+    if(!constructed) { throw std::runtime_error("model file " + filename + " contains unknown message type " + std::to_string(messages[3*i])); }
+  }
+  if(construction.cur_address() != construction.end()) {
+    throw std::runtime_error("construction records in model file " + filename + " do not match its factors and messages");
+  }
+
+  const auto* forward_relations = file.section<std::uint64_t>(h.forward_relations_offset);
+  for(INDEX i=0; i<h.no_forward_relations; ++i) {
+    ForwardPassFactorRelation(check_factor(forward_relations[2*i]), check_factor(forward_relations[2*i+1]));
+  }
+  const auto* backward_relations = file.section<std::uint64_t>(h.backward_relations_offset);
+  for(INDEX i=0; i<h.no_backward_relations; ++i) {
+    BackwardPassFactorRelation(check_factor(backward_relations[2*i]), check_factor(backward_relations[2*i+1]));
+  }
+  constant_ = h.constant;
+
+  // orderings are taken over instead of sorting the factors topologically again
+  const auto* forward = file.section<std::uint64_t>(h.forward_ordering_offset);
+  const auto* backward = file.section<std::uint64_t>(h.backward_ordering_offset);
+  for(INDEX i=0; i<h.no_factors; ++i) {
+    check_factor(forward[i]);
+    check_factor(backward[i]);
+  }
+  f_forward_sorted_.assign(forward, forward + f_.size());
+  f_backward_sorted_.assign(backward, backward + f_.size());
+  set_ordering(f_forward_sorted_, forwardOrdering_, forwardUpdateOrdering_);
+  set_ordering(f_backward_sorted_, backwardOrdering_, backwardUpdateOrdering_);
+  ordering_valid_ = true;
+
+  allocate_archive size_ar;
+  for(auto* f : f_) { f->serialize_dual(size_ar); }
+  if(size_ar.size() != h.dual_size) {
+    throw std::runtime_error("potentials in model file " + filename + " do not match its factors");
+  }
+  model_file_archive dual(file.section<char>(h.dual_offset), h.dual_size);
+  load_archive dual_ar(dual);
+  for(auto* f : f_) { f->serialize_dual(dual_ar); }
+  assert(dual.cur_address() == dual.end());
+}
+
+template<typename FMC>
+void LP<FMC>::copy_preprocessing(const LP& o)
+{
+  if(o.f_.size() != f_.size() || o.m_.size() != m_.size() || o.factor_types() != factor_types()) {
+    throw std::runtime_error("preprocessing can only be copied from a problem with the same factors and messages");
+  }
+  for(INDEX i=0; i<m_.size(); ++i) {
+    if(o.factor_address_to_index_.find(o.m_[i].left)->second != factor_address_to_index_[m_[i].left] || o.factor_address_to_index_.find(o.m_[i].right)->second != factor_address_to_index_[m_[i].right]) {
+      throw std::runtime_error("preprocessing can only be copied from a problem with the same factors and messages");
+    }
+  }
+  if(!o.ordering_valid_) {
+    throw std::runtime_error("factors of copied problem have not been sorted yet");
+  }
+
+  set_flags_dirty();
+  f_forward_sorted_ = o.f_forward_sorted_;
+  f_backward_sorted_ = o.f_backward_sorted_;
+  set_ordering(f_forward_sorted_, forwardOrdering_, forwardUpdateOrdering_);
+  set_ordering(f_backward_sorted_, backwardOrdering_, backwardUpdateOrdering_);
+  ordering_valid_ = true;
+
+  // weights and receive masks are indexed by position in the update orderings, hence valid for both problems
+  omega_anisotropic_valid_ = o.omega_anisotropic_valid_;
+  omegaForwardAnisotropic_ = o.omegaForwardAnisotropic_;
+  omegaBackwardAnisotropic_ = o.omegaBackwardAnisotropic_;
+  anisotropic_receive_mask_forward_ = o.anisotropic_receive_mask_forward_;
+  anisotropic_receive_mask_backward_ = o.anisotropic_receive_mask_backward_;
+  omega_anisotropic2_valid_ = o.omega_anisotropic2_valid_;
+  omegaForwardAnisotropic2_ = o.omegaForwardAnisotropic2_;
+  omegaBackwardAnisotropic2_ = o.omegaBackwardAnisotropic2_;
+  receive_mask_anisotropic2_forward_ = o.receive_mask_anisotropic2_forward_;
+  receive_mask_anisotropic2_backward_ = o.receive_mask_anisotropic2_backward_;
+  omega_isotropic_valid_ = o.omega_isotropic_valid_;
+  omegaForwardIsotropic_ = o.omegaForwardIsotropic_;
+  omegaBackwardIsotropic_ = o.omegaBackwardIsotropic_;
+  omega_isotropic_damped_valid_ = o.omega_isotropic_damped_valid_;
+  omegaForwardIsotropicDamped_ = o.omegaForwardIsotropicDamped_;
+  omegaBackwardIsotropicDamped_ = o.omegaBackwardIsotropicDamped_;
+  omega_mixed_valid_ = o.omega_mixed_valid_;
+  omegaForwardMixed_ = o.omegaForwardMixed_;
+  omegaBackwardMixed_ = o.omegaBackwardMixed_;
+  full_receive_mask_valid_ = o.full_receive_mask_valid_;
+  full_receive_mask_forward_ = o.full_receive_mask_forward_;
+  full_receive_mask_backward_ = o.full_receive_mask_backward_;
+
+#ifdef LP_MP_PARALLEL
+  // synchronization depends on the distribution of factors onto threads
+  if(get_executor().no_threads() == o.get_executor().no_threads()) {
+    synchronization_valid_ = o.synchronization_valid_;
+    synchronize_forward_ = o.synchronize_forward_;
+    synchronize_backward_ = o.synchronize_backward_;
+  }
+  coloring_valid_ = o.coloring_valid_;
+  color_classes_forward_ = o.color_classes_forward_;
+  color_classes_backward_ = o.color_classes_backward_;
+#endif
+
+  repamMode_ = o.repamMode_;
+}
+
+template<typename FMC>
+void LP<FMC>::potentials_changed()
+{
+  for(auto* f : f_) { f->invalidate_lower_bound(); }
+  skip_state_valid_ = false;
+  priority_schedule_valid_ = false;
+}
+
+template<typename FMC>
+void LP<FMC>::potentials_changed(FactorTypeAdapter* f)
+{
+  assert(factor_address_to_index_.count(f) > 0);
+  f->invalidate_lower_bound();
+  const INDEX k = factor_address_to_index_[f];
+  if(skip_state_valid_) {
+    factor_active_[k] = true;
+    for(const INDEX j : factor_adjacency()[k]) { factor_active_[j] = true; }
+  }
+  if(priority_schedule_valid_) {
+    auto requeue = [this](const INDEX j) {
+      const INDEX i = priority_position_[j];
+      if(i != std::numeric_limits<INDEX>::max()) {
+        priority_queue_.set(i, std::numeric_limits<REAL>::infinity());
+      }
+    };
+    requeue(k);
+    for(const INDEX j : factor_adjacency()[k]) { requeue(j); }
+  }
+}
+
+template<typename FMC>
+double LP<FMC>::LowerBound() const
+{
+    // factor types are summed up in fixed order, hence the result does not depend on the number of threads
+    REAL_ACCUMULATOR lb = constant_;
+    const bool incremental = incremental_lower_bound_arg_.getValue();
+    std::atomic<std::size_t> no_recomputed(0);
+    for_each_tuple(factors_, [this,&lb,incremental,&no_recomputed](auto& v) {
+            lb += deterministic_sum<REAL_ACCUMULATOR>(get_executor(), v.size(), [&v,incremental,&no_recomputed](const std::size_t i) {
+                    auto* f = v[i];
+                    if(incremental) {
+                        if(!f->lower_bound_valid()) { no_recomputed.fetch_add(1, std::memory_order_relaxed); }
+                        assert(std::abs(f->lower_bound_cached() - f->LowerBound()) <= eps*std::max(REAL(1.0), std::abs(f->LowerBound())));
+                        return f->lower_bound_cached();
+                    }
+                    return f->LowerBound();
+            });
+            assert(std::isfinite(lb));
     });
+    if(incremental) {
+      update_statistics_.lower_bounds_recomputed += no_recomputed;
+      update_statistics_.lower_bounds_cached += f_.size() - no_recomputed;
+    }
     return lb;
 }
 
@@ -1522,13 +2448,10 @@ double LP<FMC>::EvaluatePrimal() {
     const bool consistent = CheckPrimalConsistency();
     if(consistent == false) return std::numeric_limits<REAL>::infinity();
 
-    double cost = constant_;
-    for_each_tuple(factors_, [&cost,this](auto& v) {
-            for(auto* f : v) {
-                cost += f->EvaluatePrimal();
-            }
+    REAL_ACCUMULATOR cost = constant_;
+    for_each_tuple(factors_, [this,&cost](auto& v) {
+            cost += deterministic_sum<REAL_ACCUMULATOR>(get_executor(), v.size(), [&v](const std::size_t i) { return v[i]->EvaluatePrimal(); });
     });
-    return cost;
 
   if(debug()) { std::cout << "primal cost = " << cost << "\n"; }
 
@@ -1607,15 +2530,14 @@ template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR, typename SYNCHRONIZA
 void LP<FMC>::ComputePassAndPrimalSynchronized(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorEndIt, OMEGA_ITERATOR omegaIt, SYNCHRONIZATION_ITERATOR synchronization_begin, INDEX iteration)
 {
    //possibly do not use parallelization here
-#pragma omp parallel for schedule(static)
-  for(INDEX i=0; i<std::distance(factorIt, factorEndIt); ++i) {
+  parallel_for(get_executor(), std::distance(factorIt, factorEndIt), [&](const INDEX i) {
     auto* f = *(factorIt + i);
     if(*(synchronization_begin+i)) {
       f->UpdateFactorPrimalSynchronized(*(omegaIt + i), iteration);
     } else {
       f->UpdateFactorPrimal(*(omegaIt + i), iteration);
     }
-  }
+  });
 }
 #endif
 
@@ -1623,6 +2545,7 @@ template<typename FMC>
 void LP<FMC>::set_flags_dirty()
 {
   ordering_valid_ = false;
+  factor_adjacency_valid_ = false;
   omega_anisotropic_valid_ = false;
   omega_anisotropic2_valid_ = false;
   omega_isotropic_valid_ = false;
@@ -1630,8 +2553,12 @@ void LP<FMC>::set_flags_dirty()
   omega_mixed_valid_ = false;
   factor_partition_valid_ = false;
   full_receive_mask_valid_ = false;
+  factor_batches_valid_ = false;
+  priority_schedule_valid_ = false;
+  skip_state_valid_ = false;
 #ifdef LP_MP_PARALLEL
   synchronization_valid_ = false;
+  coloring_valid_ = false;
 #endif
 }
 
@@ -43,21 +43,33 @@ public:
          ConicBundle::PrimalExtender*&)
    {
       // load Lagrangean variables
-      this->add_weights(&x[0], -1.0);
+      if(this->sparse_Lagrangean_weights()) {
+         this->set_weights(&x[0], -1.0);
+      } else {
+         this->add_weights(&x[0], -1.0);
+      }
+
+      // solve trees concurrently, then accumulate subgradient sequentially
+      std::vector<REAL> tree_cost(this->trees_.size());
+      this->for_each_tree([&](const INDEX i, auto& t) {
+         t.solve();
+         t.compute_local_subgradient();
+         tree_cost[i] = t.primal_cost();
+      });
 
-      // compute subgradient
       objective_value = 0.0;
       ConicBundle::DVector subg(x.size(), 0.0); // this is not so nice!
-      for(auto& t : this->trees_) {
-         t.solve();
-         t.compute_mapped_subgradient(subg);
-         objective_value -= t.primal_cost();
+      for(std::size_t i=0; i<this->trees_.size(); ++i) {
+         this->trees_[i].add_mapped_subgradient(subg);
+         objective_value -= tree_cost[i];
       }
       cut_vals.push_back(objective_value);
       subgradients.push_back(subg);
 
       // remove Lagrangean variables again
-      this->add_weights(&x[0], +1.0);
+      if(!this->sparse_Lagrangean_weights()) {
+         this->add_weights(&x[0], +1.0);
+      }
 
       return 0;
    }
@@ -68,11 +80,17 @@ public:
       ConicBundle::DVector Lagrangean_vars;
       cb_solver_.get_center(Lagrangean_vars);
       // load Lagrangean variables
-      this->add_weights(&Lagrangean_vars[0], -1.0);
+      if(this->sparse_Lagrangean_weights()) {
+         this->set_weights(&Lagrangean_vars[0], -1.0);
+      } else {
+         this->add_weights(&Lagrangean_vars[0], -1.0);
+      }
 
       const REAL lb = LP_with_trees<FMC, Lagrangean_factor_star, LP_conic_bundle<FMC> >::decomposition_lower_bound();
       // remove Lagrangean variables again
-      this->add_weights(&Lagrangean_vars[0], +1.0);
+      if(!this->sparse_Lagrangean_weights()) {
+         this->add_weights(&Lagrangean_vars[0], +1.0);
+      }
 
       return lb;
    }
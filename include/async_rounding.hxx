@@ -0,0 +1,202 @@
+#ifndef LP_MP_ASYNC_ROUNDING_HXX
+#define LP_MP_ASYNC_ROUNDING_HXX
+
+#include <array>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <limits>
+#include <memory>
+#include <iostream>
+#include "config.hxx"
+#include "serialization.hxx"
+#include "executor.hxx"
+
+namespace LP_MP {
+
+// primal rounding on a copy of an LP in a background thread.
+// submit copies the reparametrization into one of two buffers between iterations. The thread loads it into its copy and runs a forward and backward pass with primal computation there.
+// A snapshot submitted while the thread is busy replaces an older one that was not picked up yet, hence optimization of the original LP only pays for the copy.
+// The best primal found is kept and can be loaded into the original LP with fetch.
+template<typename LP_TYPE>
+class async_primal_rounding {
+public:
+   // lp must not be optimized concurrently, its factors are sorted and copied
+   async_primal_rounding(LP_TYPE& lp)
+   : lp_(lp),
+   rounding_lp_(lp)
+   {
+      lp.SortFactors();
+      // passes on the copy run in the background thread only
+      rounding_lp_.set_executor(std::make_shared<sequential_executor>());
+      rounding_lp_.copy_preprocessing(lp);
+      worker_ = std::thread([this]() { work_loop(); });
+   }
+
+   async_primal_rounding(const async_primal_rounding&) = delete;
+   async_primal_rounding& operator=(const async_primal_rounding&) = delete;
+
+   // a snapshot that is still waiting is dropped
+   ~async_primal_rounding()
+   {
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         stop_ = true;
+         ready_ = none;
+      }
+      cv_.notify_all();
+      worker_.join();
+   }
+
+   // hand the current reparametrization of lp to the thread, rounding is done in reparametrization mode
+   // must be called between iterations, when no factor is being updated
+   void submit(const LPReparametrizationMode mode)
+   {
+      std::size_t b;
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         b = loading_ == 0 ? 1 : 0;
+         if(ready_ == b) { ready_ = none; } // older snapshot was not picked up yet, replace it
+      }
+
+      allocate_archive size_ar;
+      for(INDEX i=0; i<lp_.GetNumberOfFactors(); ++i) { lp_.GetFactor(i)->serialize_dual(size_ar); }
+      auto& buffer = buffers_[b];
+      buffer.resize(size_ar.size());
+      serialization_archive dual(buffer.data(), buffer.size());
+      save_archive save_ar(dual);
+      for(INDEX i=0; i<lp_.GetNumberOfFactors(); ++i) { lp_.GetFactor(i)->serialize_dual(save_ar); }
+      dual.release_memory();
+
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         ready_ = b;
+         ready_mode_ = mode;
+      }
+      cv_.notify_all();
+   }
+
+   // if a primal better than the last fetched one was found, write it into the factors of lp and return its cost, otherwise return infinity.
+   // must be called between iterations
+   REAL fetch()
+   {
+      std::vector<char> primal;
+      REAL cost;
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         if(!error_.empty()) { throw std::runtime_error(error_); }
+         if(!new_primal_) { return std::numeric_limits<REAL>::infinity(); }
+         new_primal_ = false;
+         primal = best_primal_;
+         cost = best_cost_;
+      }
+      serialization_archive primal_ar(primal.data(), primal.size());
+      load_archive load_ar(primal_ar);
+      for(INDEX i=0; i<lp_.GetNumberOfFactors(); ++i) { lp_.GetFactor(i)->serialize_primal(load_ar); }
+      primal_ar.release_memory();
+      return cost;
+   }
+
+   // block until all submitted snapshots are rounded
+   void wait()
+   {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return (ready_ == none && !rounding_) || !error_.empty(); });
+   }
+
+   INDEX no_roundings() const
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return no_roundings_;
+   }
+
+private:
+   constexpr static std::size_t none = std::numeric_limits<std::size_t>::max();
+
+   void work_loop()
+   {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while(true) {
+         cv_.wait(lock, [this]() { return stop_ || ready_ != none; });
+         if(stop_) { return; }
+         loading_ = ready_;
+         ready_ = none;
+         rounding_ = true;
+         const auto mode = ready_mode_;
+         lock.unlock();
+
+         std::string error;
+         try {
+            round(buffers_[loading_], mode);
+         } catch(const std::exception& e) {
+            error = std::string("asynchronous primal rounding failed: ") + e.what();
+         }
+
+         lock.lock();
+         if(!error.empty()) { error_ = error; }
+         rounding_ = false;
+         ++no_roundings_;
+         cv_.notify_all();
+      }
+   }
+
+   // called without holding the mutex, the buffer is released as soon as it is loaded
+   void round(const std::vector<char>& buffer, const LPReparametrizationMode mode)
+   {
+      serialization_archive dual(buffer.data(), buffer.size());
+      load_archive load_ar(dual);
+      for(INDEX i=0; i<rounding_lp_.GetNumberOfFactors(); ++i) { rounding_lp_.GetFactor(i)->serialize_dual(load_ar); }
+      dual.release_memory();
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         loading_ = none;
+      }
+      rounding_lp_.potentials_changed();
+
+      rounding_lp_.set_reparametrization(mode);
+      rounding_lp_.ComputePassAndPrimal(++timestamp_);
+      const REAL cost = rounding_lp_.EvaluatePrimal();
+      if(debug()) { std::cout << "asynchronous rounding found primal of cost " << cost << "\n"; }
+
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         if(!(cost < best_cost_)) { return; }
+      }
+      allocate_archive size_ar;
+      for(INDEX i=0; i<rounding_lp_.GetNumberOfFactors(); ++i) { rounding_lp_.GetFactor(i)->serialize_primal(size_ar); }
+      std::vector<char> primal(size_ar.size());
+      serialization_archive primal_ar(primal.data(), primal.size());
+      save_archive save_ar(primal_ar);
+      for(INDEX i=0; i<rounding_lp_.GetNumberOfFactors(); ++i) { rounding_lp_.GetFactor(i)->serialize_primal(save_ar); }
+      primal_ar.release_memory();
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      best_primal_ = std::move(primal);
+      best_cost_ = cost;
+      new_primal_ = true;
+   }
+
+   LP_TYPE& lp_;
+   LP_TYPE rounding_lp_; // only accessed by the background thread after construction
+   INDEX timestamp_ = 0; // primal computation in rounding_lp_ recognizes earlier passes by it
+   std::array<std::vector<char>,2> buffers_;
+   std::size_t ready_ = none; // buffer holding a snapshot not yet picked up
+   std::size_t loading_ = none; // buffer being loaded into rounding_lp_
+   LPReparametrizationMode ready_mode_ = LPReparametrizationMode::Undefined;
+   bool rounding_ = false;
+   bool stop_ = false;
+   INDEX no_roundings_ = 0;
+   std::vector<char> best_primal_;
+   REAL best_cost_ = std::numeric_limits<REAL>::infinity();
+   bool new_primal_ = false;
+   std::string error_;
+   mutable std::mutex mutex_;
+   std::condition_variable cv_;
+   std::thread worker_;
+};
+
+} // end namespace LP_MP
+
+#endif // LP_MP_ASYNC_ROUNDING_HXX
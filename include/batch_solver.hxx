@@ -0,0 +1,166 @@
+#ifndef LP_MP_BATCH_SOLVER_HXX
+#define LP_MP_BATCH_SOLVER_HXX
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <string>
+#include <limits>
+#include "config.hxx"
+#include "LP_MP.h"
+#include "executor.hxx"
+#include "serialization.hxx"
+
+namespace LP_MP {
+
+// solves many instances with the same factors, messages and factor relations that differ only in their potentials.
+// One LP per thread of the executor is built by the build function. Factors are sorted and weights are computed only for the first one, the others copy them.
+// Instances are distributed onto the LPs, each one is optimized sequentially on one thread. Before the potentials of an instance are set, the potentials given by the build function are restored.
+template<typename FMC>
+class batch_solver {
+public:
+   using lp_type = LP<FMC>;
+   // adds factors, messages and factor relations
+   using build_function = std::function<void(lp_type&)>;
+   // sets potentials of instance i, e.g. through GetFactor()
+   using potential_function = std::function<void(lp_type&, const INDEX)>;
+   // reads the solution of instance i after optimization, e.g. primal labels
+   using result_function = std::function<void(lp_type&, const INDEX)>;
+
+   struct instance_result {
+      REAL lower_bound;
+      REAL primal_cost; // infinity if no primal rounding is done
+      INDEX iterations;
+   };
+
+   // options are parsed as by Solver and may contain LP options (e.g. --reparametrizationType) and the batch options below
+   batch_solver(build_function build, const std::vector<std::string>& options, executor& e = default_executor())
+   : executor_(e)
+   {
+      const INDEX no_workers = std::max(INDEX(1), executor_.no_threads());
+      workers_.reserve(no_workers);
+      for(INDEX w=0; w<no_workers; ++w) {
+         workers_.push_back(std::make_unique<worker>());
+         auto& wk = *workers_.back();
+         std::vector<std::string> args(options);
+         wk.cmd.parse(args);
+
+         build(wk.lp);
+         // instances are run concurrently, one per thread, hence a single instance must not spawn threads
+         wk.lp.set_executor(std::make_shared<sequential_executor>());
+         wk.lp.Begin();
+         if(w == 0) {
+            wk.lp.set_reparametrization(LPReparametrizationModeConvert(wk.standard_reparametrization_arg.getValue()));
+            wk.lp.get_omega();
+            initial_potentials_ = save_potentials(wk.lp);
+         } else {
+            wk.lp.copy_preprocessing(workers_[0]->lp);
+         }
+      }
+   }
+
+   batch_solver(const batch_solver&) = delete;
+   batch_solver& operator=(const batch_solver&) = delete;
+
+   INDEX no_workers() const { return workers_.size(); }
+
+   std::vector<instance_result> solve(const INDEX no_instances, potential_function set_potentials, result_function read_result = result_function())
+   {
+      std::vector<instance_result> results(no_instances);
+      std::atomic<INDEX> next_instance(0);
+      executor_.run(workers_.size(), [&](const INDEX w) {
+            auto& wk = *workers_[w];
+            for(INDEX i = next_instance++; i < no_instances; i = next_instance++) {
+               results[i] = solve_instance(wk, i, set_potentials);
+               if(read_result) { read_result(wk.lp, i); }
+            }
+      });
+      return results;
+   }
+
+private:
+   // every worker parses the options into its own command line, since TCLAP arguments are bound to one command line
+   struct worker {
+      worker()
+      : cmd("batch solver", ' ', "0.1"),
+      lp(cmd),
+      max_iter_arg("","maxIter","maximum number of iterations per instance, default = 1000",false,1000,&positiveIntegerConstraint,cmd),
+      lower_bound_interval_arg("","lowerBoundComputationInterval","lower bound computation performed every x-th iteration, default = 1",false,1,&positiveIntegerConstraint,cmd),
+      min_dual_improvement_arg("","minDualImprovement","minimum dual improvement between lower bound computations, default = 0",false,0.0,"positive real",cmd),
+      standard_reparametrization_arg("","standardReparametrization","mode of reparametrization",false,"anisotropic","{anisotropic|anisotropic2|uniform|damped_uniform|mixed}",cmd),
+      primal_arg("","primalRounding","round a primal solution in a last pass after optimizing an instance",cmd,false)
+      {}
+
+      TCLAP::CmdLine cmd;
+      lp_type lp;
+      TCLAP::ValueArg<INDEX> max_iter_arg;
+      TCLAP::ValueArg<INDEX> lower_bound_interval_arg;
+      TCLAP::ValueArg<REAL> min_dual_improvement_arg;
+      TCLAP::ValueArg<std::string> standard_reparametrization_arg;
+      TCLAP::SwitchArg primal_arg;
+      INDEX timestamp = 0; // increases over all instances, primal rounding uses it to recognize primals of earlier passes
+   };
+
+   instance_result solve_instance(worker& wk, const INDEX instance, potential_function& set_potentials)
+   {
+      auto& lp = wk.lp;
+      load_potentials(lp);
+      set_potentials(lp, instance);
+      lp.potentials_changed();
+
+      const INDEX max_iter = wk.max_iter_arg.getValue();
+      const INDEX lb_interval = wk.lower_bound_interval_arg.getValue();
+      const REAL min_improvement = wk.min_dual_improvement_arg.getValue();
+      REAL lb = lp.LowerBound();
+      INDEX iter = 0;
+      while(iter < max_iter) {
+         lp.ComputePass(++wk.timestamp);
+         ++iter;
+         if(iter % lb_interval == 0) {
+            const REAL new_lb = lp.LowerBound();
+            const bool converged = wk.min_dual_improvement_arg.isSet() && new_lb - lb < min_improvement;
+            lb = new_lb;
+            if(converged) { break; }
+         }
+      }
+
+      instance_result r{lp.LowerBound(), std::numeric_limits<REAL>::infinity(), iter};
+      if(wk.primal_arg.getValue()) {
+         lp.ComputePassAndPrimal(++wk.timestamp);
+         r.lower_bound = lp.LowerBound();
+         r.primal_cost = lp.EvaluatePrimal();
+      }
+      return r;
+   }
+
+   static std::vector<char> save_potentials(lp_type& lp)
+   {
+      allocate_archive size_ar;
+      for(INDEX i=0; i<lp.GetNumberOfFactors(); ++i) { lp.GetFactor(i)->serialize_dual(size_ar); }
+      std::vector<char> buffer(size_ar.size());
+      serialization_archive dual(buffer.data(), buffer.size());
+      save_archive save_ar(dual);
+      for(INDEX i=0; i<lp.GetNumberOfFactors(); ++i) { lp.GetFactor(i)->serialize_dual(save_ar); }
+      dual.release_memory();
+      return buffer;
+   }
+
+   // all workers read the same buffer, every one through its own archive
+   void load_potentials(lp_type& lp) const
+   {
+      serialization_archive dual(initial_potentials_.data(), initial_potentials_.size());
+      load_archive load_ar(dual);
+      for(INDEX i=0; i<lp.GetNumberOfFactors(); ++i) { lp.GetFactor(i)->serialize_dual(load_ar); }
+      assert(dual.cur_address() == dual.end());
+      dual.release_memory();
+   }
+
+   executor& executor_;
+   std::vector<std::unique_ptr<worker>> workers_;
+   std::vector<char> initial_potentials_; // potentials as given by the build function
+};
+
+} // end namespace LP_MP
+
+#endif // LP_MP_BATCH_SOLVER_HXX
@@ -0,0 +1,182 @@
+#ifndef LP_MP_CHECKPOINT_HXX
+#define LP_MP_CHECKPOINT_HXX
+
+#include <array>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "config.hxx"
+#include "serialization.hxx"
+#include "model_file.hxx"
+
+namespace LP_MP {
+
+// periodic snapshots of all dual reparametrizations, written to disk by a background thread.
+// The snapshot itself is copied into one of two buffers between iterations, while the writer thread may still write the other one, so optimization only pays for the copy.
+// Files are first written under a temporary name and then renamed, so that an interrupted write leaves the previous checkpoint intact.
+// Only potentials and the iteration are stored: after resuming, the best primal solution found before is lost and primal rounding starts anew.
+class dual_checkpoint {
+public:
+   dual_checkpoint(const std::string& filename)
+   : filename_(filename),
+   writer_([this]() { write_loop(); })
+   {}
+
+   dual_checkpoint(const dual_checkpoint&) = delete;
+   dual_checkpoint& operator=(const dual_checkpoint&) = delete;
+
+   // a snapshot that is still waiting to be written is written before returning
+   ~dual_checkpoint()
+   {
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         stop_ = true;
+      }
+      cv_.notify_all();
+      writer_.join();
+   }
+
+   // must be called between iterations, when no factor is being updated
+   template<typename LP_TYPE>
+   void save(LP_TYPE& lp, const INDEX iteration)
+   {
+      std::size_t b;
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         b = writing_ == 0 ? 1 : 0;
+         if(ready_ == b) { ready_ = none; } // older snapshot was not written yet, replace it
+      }
+
+      allocate_archive size_ar;
+      for(INDEX i=0; i<lp.GetNumberOfFactors(); ++i) { lp.GetFactor(i)->serialize_dual(size_ar); }
+
+      checkpoint_header h;
+      std::memcpy(h.magic, checkpoint_magic, sizeof(checkpoint_magic));
+      h.version = checkpoint_version;
+      h.real_size = sizeof(REAL);
+      h.fmc_hash = fmc_name_hash(LP_TYPE::FMC::name);
+      h.no_factors = lp.GetNumberOfFactors();
+      h.iteration = iteration;
+      h.dual_size = size_ar.size();
+
+      auto& buffer = buffers_[b];
+      buffer.resize(sizeof(checkpoint_header) + h.dual_size);
+      std::memcpy(buffer.data(), &h, sizeof(checkpoint_header));
+      serialization_archive dual(buffer.data() + sizeof(checkpoint_header), h.dual_size);
+      save_archive save_ar(dual);
+      for(INDEX i=0; i<lp.GetNumberOfFactors(); ++i) { lp.GetFactor(i)->serialize_dual(save_ar); }
+      dual.release_memory();
+
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         ready_ = b;
+      }
+      cv_.notify_all();
+   }
+
+   // block until all snapshots are on disk
+   void wait()
+   {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return ready_ == none && writing_ == none; });
+      if(!error_.empty()) { throw std::runtime_error(error_); }
+   }
+
+   bool exists() const
+   {
+      std::ifstream file(filename_, std::ios::binary);
+      return file.good();
+   }
+
+   // reload dual reparametrizations of lp. Returns the iteration in which the checkpoint was taken.
+   template<typename LP_TYPE>
+   INDEX load(LP_TYPE& lp) const
+   {
+      std::ifstream file(filename_, std::ios::binary);
+      if(!file) { throw std::runtime_error("could not open checkpoint " + filename_); }
+      checkpoint_header h;
+      file.read(reinterpret_cast<char*>(&h), sizeof(h));
+      if(!file || std::memcmp(h.magic, checkpoint_magic, sizeof(checkpoint_magic)) != 0) { throw std::runtime_error(filename_ + " is not a checkpoint"); }
+      if(h.version != checkpoint_version) { throw std::runtime_error("checkpoint " + filename_ + " has version " + std::to_string(h.version) + ", expected " + std::to_string(checkpoint_version)); }
+      if(h.real_size != sizeof(REAL)) { throw std::runtime_error("checkpoint " + filename_ + " was written with different floating point precision"); }
+      if(h.fmc_hash != fmc_name_hash(LP_TYPE::FMC::name) || h.no_factors != lp.GetNumberOfFactors()) { throw std::runtime_error("checkpoint " + filename_ + " does not match constructed problem"); }
+
+      allocate_archive size_ar;
+      for(INDEX i=0; i<lp.GetNumberOfFactors(); ++i) { lp.GetFactor(i)->serialize_dual(size_ar); }
+      if(size_ar.size() != h.dual_size) { throw std::runtime_error("checkpoint " + filename_ + " does not match constructed problem"); }
+
+      serialization_archive dual(size_ar);
+      file.read(dual.begin(), h.dual_size);
+      if(!file) { throw std::runtime_error("checkpoint " + filename_ + " is truncated"); }
+      load_archive load_ar(dual);
+      for(INDEX i=0; i<lp.GetNumberOfFactors(); ++i) { lp.GetFactor(i)->serialize_dual(load_ar); }
+      return h.iteration;
+   }
+
+   const std::string& filename() const { return filename_; }
+
+private:
+   struct checkpoint_header {
+      char magic[8];
+      std::uint32_t version;
+      std::uint32_t real_size;
+      std::uint64_t fmc_hash;
+      std::uint64_t no_factors;
+      std::uint64_t iteration;
+      std::uint64_t dual_size;
+   };
+   constexpr static char checkpoint_magic[8] = {'L','P','M','P','C','K','P','T'};
+   constexpr static std::uint32_t checkpoint_version = 1;
+   constexpr static std::size_t none = std::numeric_limits<std::size_t>::max();
+
+   void write_loop()
+   {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while(true) {
+         cv_.wait(lock, [this]() { return stop_ || ready_ != none; });
+         if(ready_ == none) { assert(stop_); return; }
+         writing_ = ready_;
+         ready_ = none;
+         const auto& buffer = buffers_[writing_];
+         lock.unlock();
+
+         const std::string tmp_filename = filename_ + ".tmp";
+         std::string error;
+         {
+            std::ofstream file(tmp_filename, std::ios::binary | std::ios::trunc);
+            file.write(buffer.data(), buffer.size());
+            if(!file) { error = "could not write checkpoint " + tmp_filename; }
+         }
+         if(error.empty() && std::rename(tmp_filename.c_str(), filename_.c_str()) != 0) { error = "could not rename checkpoint " + tmp_filename + " to " + filename_; }
+         if(!error.empty()) { std::cerr << error << "\n"; }
+         else if(debug()) { std::cout << "wrote checkpoint " << filename_ << "\n"; }
+
+         lock.lock();
+         if(!error.empty()) { error_ = error; }
+         writing_ = none;
+         cv_.notify_all();
+      }
+   }
+
+   const std::string filename_;
+   std::array<std::vector<char>,2> buffers_;
+   std::size_t ready_ = none; // buffer holding a snapshot that was not yet picked up by the writer
+   std::size_t writing_ = none; // buffer currently written to disk
+   bool stop_ = false;
+   std::string error_;
+   std::mutex mutex_;
+   std::condition_variable cv_;
+   std::thread writer_; // must be initialized last
+};
+
+} // end namespace LP_MP
+
+#endif // LP_MP_CHECKPOINT_HXX
@@ -20,14 +20,19 @@
 namespace LP_MP {
 
    // data types for all floating point/integer operations 
-   // float is inaccurate for large problems and I observed oscillation. Possibly, some sort of numerical stabilization needs to be employed
-   //using REAL = float;
-   //constexpr std::size_t REAL_ALIGNMENT = 8;
-   //using REAL_VECTOR = simdpp::float32<REAL_ALIGNMENT>;
-
+   // Compile with -DLP_MP_SINGLE_PRECISION to store potentials and messages as float. This halves memory traffic and doubles the SIMD width.
+   // float is inaccurate for large problems and I observed oscillation, hence sums over all factors (lower bound, primal cost) are accumulated in REAL_ACCUMULATOR.
+#ifdef LP_MP_SINGLE_PRECISION
+   using REAL = float;
+   constexpr std::size_t REAL_ALIGNMENT = 8;
+   using REAL_VECTOR = simdpp::float32<REAL_ALIGNMENT>;
+#else
    using REAL = double;
    constexpr std::size_t REAL_ALIGNMENT = 4;
    using REAL_VECTOR = simdpp::float64<REAL_ALIGNMENT>;
+#endif
+   using REAL_ACCUMULATOR = double;
+   static_assert(REAL_ALIGNMENT*sizeof(REAL) == 32, "SIMD kernels assume 256 bit registers");
 
    using INDEX = std::size_t;
    using UNSIGNED_INDEX = INDEX;
@@ -0,0 +1,314 @@
+#ifndef LP_MP_CSR_GRAPH_HXX
+#define LP_MP_CSR_GRAPH_HXX
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <numeric>
+#include <iterator>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <cassert>
+#include "graph.hxx"
+#include "help_functions.hxx"
+
+namespace LP_MP {
+
+// compact undirected graph in compressed sparse row format, read only after construction.
+// Adjacency lists are stored contiguously as 32 bit heads, sorted by head. Edge information is stored once per undirected edge in a separate array, indexed by edge ids.
+// Edge ids enumerate edges (i,j), i<j, lexicographically. For heads j>i of node i they are consecutive and computed from the position in the adjacency list, only edge ids of heads j<i are stored.
+// Per undirected edge with 8 byte edge information this takes 2*4 (heads) + 4 (stored ids) + 8 = 20 bytes, compared to 2*(8+8+8) = 48 bytes for graph.
+// Traversals read heads only and touch edge information when needed, hence they stream through memory.
+template<typename EDGE_INFORMATION>
+class csr_graph {
+public:
+   using node_type = std::uint32_t;
+   using edge_information = EDGE_INFORMATION;
+
+   class edge_iterator;
+
+   // lightweight reference to an entry of an adjacency list with the interface of graph::edge_type
+   class edge_type {
+   public:
+      edge_type(const csr_graph& g, const std::size_t tail, const std::size_t pos) : g_(&g), tail_(tail), pos_(pos) {}
+
+      std::size_t tail() const { return tail_; }
+      std::size_t head() const { return g_->heads_[pos_]; }
+      std::size_t id() const { return g_->edge_id_at(tail_, pos_); }
+      const EDGE_INFORMATION& edge() const { return g_->edges_[id()]; }
+      edge_type sister() const { return edge_type(*g_, head(), g_->position(head(), tail_)); }
+
+      bool operator<(const edge_type& o) const { return head() < o.head(); }
+
+   private:
+      friend class csr_graph::edge_iterator;
+      const csr_graph* g_;
+      std::size_t tail_;
+      std::size_t pos_;
+   };
+
+   class edge_iterator {
+   public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = edge_type;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const edge_type*;
+      using reference = const edge_type&;
+
+      edge_iterator(const csr_graph& g, const std::size_t tail, const std::size_t pos) : e_(g, tail, pos) {}
+
+      const edge_type& operator*() const { return e_; }
+      const edge_type* operator->() const { return &e_; }
+      edge_iterator& operator++() { ++e_.pos_; return *this; }
+      edge_iterator& operator--() { --e_.pos_; return *this; }
+      edge_iterator& operator+=(const difference_type n) { e_.pos_ += n; return *this; }
+      edge_iterator operator+(const difference_type n) const { auto it = *this; it += n; return it; }
+      difference_type operator-(const edge_iterator& o) const { return difference_type(e_.pos_) - difference_type(o.e_.pos_); }
+      bool operator==(const edge_iterator& o) const { return e_.pos_ == o.e_.pos_; }
+      bool operator!=(const edge_iterator& o) const { return e_.pos_ != o.e_.pos_; }
+      bool operator<(const edge_iterator& o) const { return e_.pos_ < o.e_.pos_; }
+
+   private:
+      edge_type e_;
+   };
+
+   csr_graph() : offsets_(1, 0) {}
+
+   constexpr static auto no_op = [](const auto& edge) { return EDGE_INFORMATION{}; };
+   template<typename EDGE_ITERATOR>
+   csr_graph(EDGE_ITERATOR edge_begin, EDGE_ITERATOR edge_end)
+   : csr_graph(edge_begin, edge_end, no_op)
+   {}
+
+   // edges are given as pairs of nodes in any order and orientation, but without duplicates. f computes the edge information from an edge.
+   template<typename EDGE_ITERATOR, typename EDGE_INFORMATION_LAMBDA>
+   csr_graph(EDGE_ITERATOR edge_begin, EDGE_ITERATOR edge_end, EDGE_INFORMATION_LAMBDA f)
+   {
+      std::vector<std::array<node_type,2>> edges;
+      std::vector<EDGE_INFORMATION> edge_information;
+      std::size_t no_nodes = 0;
+      for(auto edge_it=edge_begin; edge_it!=edge_end; ++edge_it) {
+         const std::size_t i = std::min((*edge_it)[0], (*edge_it)[1]);
+         const std::size_t j = std::max((*edge_it)[0], (*edge_it)[1]);
+         assert(i != j);
+         if(j >= std::numeric_limits<node_type>::max()) { throw std::runtime_error("csr_graph supports at most 2^32-1 nodes"); }
+         no_nodes = std::max(no_nodes, j+1);
+         edges.push_back({node_type(i), node_type(j)});
+         edge_information.push_back(f(*edge_it));
+      }
+      if(edges.size() >= std::numeric_limits<node_type>::max()) { throw std::runtime_error("csr_graph supports at most 2^32-1 edges"); }
+
+      // edge ids are positions in lexicographical order
+      std::vector<std::size_t> order(edges.size());
+      std::iota(order.begin(), order.end(), 0);
+      std::sort(order.begin(), order.end(), [&](const std::size_t e1, const std::size_t e2) { return edges[e1] < edges[e2]; });
+      edges_.reserve(edges.size());
+      for(const std::size_t e : order) { edges_.push_back(std::move(edge_information[e])); }
+      edge_information.clear();
+      edge_information.shrink_to_fit();
+
+      std::vector<std::size_t> no_lower(no_nodes, 0);
+      std::vector<std::size_t> no_upper(no_nodes, 0);
+      for(const auto& e : edges) {
+         no_upper[e[0]]++;
+         no_lower[e[1]]++;
+      }
+      offsets_.resize(no_nodes+1);
+      split_.resize(no_nodes);
+      upper_offset_.resize(no_nodes);
+      offsets_[0] = 0;
+      std::size_t u = 0;
+      for(std::size_t i=0; i<no_nodes; ++i) {
+         split_[i] = offsets_[i] + no_lower[i];
+         offsets_[i+1] = split_[i] + no_upper[i];
+         upper_offset_[i] = u;
+         u += no_upper[i];
+      }
+
+      // edges in lexicographical order arrive sorted in the upper part of the tail's and the lower part of the head's adjacency list
+      heads_.resize(2*edges.size());
+      lower_ids_.resize(edges.size());
+      std::fill(no_lower.begin(), no_lower.end(), 0);
+      std::fill(no_upper.begin(), no_upper.end(), 0);
+      for(std::size_t id=0; id<order.size(); ++id) {
+         const auto [i,j] = edges[order[id]];
+         heads_[split_[i] + no_upper[i]++] = j;
+         const std::size_t pos = offsets_[j] + no_lower[j]++;
+         heads_[pos] = i;
+         lower_ids_[pos - upper_offset_[j]] = node_type(id);
+      }
+
+      check_graph();
+   }
+
+   // compact copy of a graph with the same edge information
+   template<bool SUPPORT_SISTER, bool SUPPORT_MASKING>
+   csr_graph(const graph<EDGE_INFORMATION, SUPPORT_SISTER, SUPPORT_MASKING>& g)
+   {
+      std::vector<std::array<std::size_t,2>> edges;
+      std::vector<const EDGE_INFORMATION*> edge_information;
+      g.for_each_edge([&](const std::size_t i, const std::size_t j, const EDGE_INFORMATION& e) {
+         edges.push_back({i,j});
+         edge_information.push_back(&e);
+      });
+      std::size_t e = 0;
+      *this = csr_graph(edges.begin(), edges.end(), [&](const auto&) { return *edge_information[e++]; });
+      // isolated nodes at the end
+      const std::size_t n = no_nodes();
+      for(std::size_t i=n; i<g.no_nodes(); ++i) {
+         offsets_.push_back(offsets_.back());
+         split_.push_back(offsets_.back());
+         upper_offset_.push_back(edges_.size());
+      }
+   }
+
+   std::size_t no_nodes() const { return offsets_.size()-1; }
+   std::size_t no_edges() const { return edges_.size(); }
+   std::size_t no_edges(const std::size_t i) const { return offsets_[i+1] - offsets_[i]; }
+
+   edge_iterator begin(const std::size_t i) const { return edge_iterator(*this, i, offsets_[i]); }
+   edge_iterator end(const std::size_t i) const { return edge_iterator(*this, i, offsets_[i+1]); }
+
+   // heads of node i, sorted
+   const node_type* heads_begin(const std::size_t i) const { return heads_.data() + offsets_[i]; }
+   const node_type* heads_end(const std::size_t i) const { return heads_.data() + offsets_[i+1]; }
+
+   bool edge_present(const std::size_t i, const std::size_t j) const
+   {
+      assert(i != j && std::max(i,j) < no_nodes());
+      return std::binary_search(heads_begin(i), heads_end(i), node_type(j));
+   }
+
+   std::size_t edge_id(const std::size_t i, const std::size_t j) const
+   {
+      assert(edge_present(i,j));
+      return edge_id_at(i, position(i,j));
+   }
+
+   const EDGE_INFORMATION& edge(const std::size_t i, const std::size_t j) const { return edges_[edge_id(i,j)]; }
+   EDGE_INFORMATION& edge(const std::size_t i, const std::size_t j) { return edges_[edge_id(i,j)]; }
+   const EDGE_INFORMATION& edge(const std::size_t id) const { return edges_[id]; }
+   EDGE_INFORMATION& edge(const std::size_t id) { return edges_[id]; }
+
+   // edges (i,j), i<j, in order of their ids
+   template<typename LAMBDA>
+   void for_each_edge(LAMBDA f) const
+   {
+      for(std::size_t i=0; i<no_nodes(); ++i) {
+         for(std::size_t pos=split_[i]; pos<offsets_[i+1]; ++pos) {
+            f(i, std::size_t(heads_[pos]), edges_[upper_offset_[i] + pos - split_[i]]);
+         }
+      }
+   }
+
+   // as graph::for_each_triangle, f is called with edge_type references ij, ik, jk.
+   // Neighbours k>j of i and j are exactly the upper parts of their adjacency lists, hence only heads are read for intersecting.
+   template<typename LAMBDA>
+   void for_each_triangle(LAMBDA f, const triangle_intersection_kernel kernel = triangle_intersection_kernel::adaptive) const
+   {
+      std::vector<std::array<std::size_t,2>> common_nodes; // positions of ik and jk
+      std::vector<std::uint64_t> neighbours(kernel == triangle_intersection_kernel::merge || kernel == triangle_intersection_kernel::galloping ? 0 : (no_nodes()+63)/64, 0);
+      auto position_merge = [&](const node_type& ik, const node_type& jk) -> std::array<std::size_t,2> {
+         assert(ik == jk);
+         return {std::size_t(&ik - heads_.data()), std::size_t(&jk - heads_.data())};
+      };
+
+      for(std::size_t i=0; i<no_nodes(); ++i) {
+         const node_type* i_upper_begin = heads_.data() + split_[i];
+         const node_type* i_end = heads_end(i);
+         const bool use_bitset = kernel == triangle_intersection_kernel::bitset || (kernel == triangle_intersection_kernel::adaptive && no_edges(i) >= triangle_bitset_min_degree);
+         if(use_bitset) {
+            for(const node_type* k=i_upper_begin; k!=i_end; ++k) { neighbours[*k/64] |= std::uint64_t(1) << (*k%64); }
+         }
+
+         for(const node_type* ij=i_upper_begin; ij!=i_end; ++ij) {
+            const std::size_t j = *ij;
+            const node_type* i_begin = ij+1;
+            const node_type* j_begin = heads_.data() + split_[j];
+            const node_type* j_end = heads_end(j);
+            const std::size_t i_size = i_end - i_begin;
+            const std::size_t j_size = j_end - j_begin;
+
+            common_nodes.clear();
+            if(use_bitset && (kernel == triangle_intersection_kernel::bitset || j_size < triangle_galloping_ratio*i_size)) {
+               for(const node_type* jk=j_begin; jk!=j_end; ++jk) {
+                  if(neighbours[*jk/64] & (std::uint64_t(1) << (*jk%64))) {
+                     const node_type* ik = std::lower_bound(i_begin, i_end, *jk);
+                     assert(ik != i_end && *ik == *jk);
+                     common_nodes.push_back(position_merge(*ik, *jk));
+                  }
+               }
+            } else if(kernel == triangle_intersection_kernel::galloping || (kernel == triangle_intersection_kernel::adaptive && std::max(i_size, j_size) >= triangle_galloping_ratio*std::min(i_size, j_size))) {
+               if(i_size <= j_size) {
+                  set_intersection_galloping(i_begin, i_end, j_begin, j_end, std::back_inserter(common_nodes), std::less<node_type>(), position_merge);
+               } else {
+                  set_intersection_galloping(j_begin, j_end, i_begin, i_end, std::back_inserter(common_nodes), std::less<node_type>(),
+                        [&](const node_type& jk, const node_type& ik) { return position_merge(ik, jk); });
+               }
+            } else {
+               set_intersection_merge(i_begin, i_end, j_begin, j_end, std::back_inserter(common_nodes), std::less<node_type>(), position_merge);
+            }
+
+            const edge_type ij_edge(*this, i, ij - heads_.data());
+            for(const auto [ik, jk] : common_nodes) {
+               f(i, j, std::size_t(heads_[ik]), ij_edge, edge_type(*this, i, ik), edge_type(*this, j, jk));
+            }
+         }
+
+         if(use_bitset) {
+            for(const node_type* k=i_upper_begin; k!=i_end; ++k) { neighbours[*k/64] = 0; }
+         }
+      }
+   }
+
+   // bytes used for the graph structure and edge information
+   std::size_t memory_size() const
+   {
+      return heads_.capacity()*sizeof(node_type) + lower_ids_.capacity()*sizeof(node_type) + edges_.capacity()*sizeof(EDGE_INFORMATION)
+         + (offsets_.capacity() + split_.capacity() + upper_offset_.capacity())*sizeof(std::size_t);
+   }
+
+   void check_graph() const
+   {
+      assert(offsets_.size() == split_.size()+1 && split_.size() == upper_offset_.size());
+      for(std::size_t i=0; i<no_nodes(); ++i) {
+         assert(std::is_sorted(heads_begin(i), heads_end(i)));
+         assert(std::adjacent_find(heads_begin(i), heads_end(i)) == heads_end(i));
+         for(std::size_t pos=offsets_[i]; pos<offsets_[i+1]; ++pos) {
+            assert((pos < split_[i]) == (heads_[pos] < i));
+            assert(edge_id_at(heads_[pos], position(heads_[pos], i)) == edge_id_at(i, pos));
+         }
+      }
+   }
+
+private:
+   // position of head j in the adjacency list of i
+   std::size_t position(const std::size_t i, const std::size_t j) const
+   {
+      const node_type* pos = std::lower_bound(heads_begin(i), heads_end(i), node_type(j));
+      assert(pos != heads_end(i) && *pos == j);
+      return pos - heads_.data();
+   }
+
+   std::size_t edge_id_at(const std::size_t i, const std::size_t pos) const
+   {
+      assert(offsets_[i] <= pos && pos < offsets_[i+1]);
+      if(pos < split_[i]) {
+         return lower_ids_[pos - upper_offset_[i]];
+      } else {
+         return upper_offset_[i] + pos - split_[i];
+      }
+   }
+
+   std::vector<std::size_t> offsets_; // adjacency list of node i is heads_[offsets_[i], offsets_[i+1])
+   std::vector<std::size_t> split_; // first position in adjacency list of node i with head larger than i
+   std::vector<std::size_t> upper_offset_; // number of edges (i',j) with i'<i, i.e. edge id of first head larger than i
+   std::vector<node_type> heads_;
+   std::vector<node_type> lower_ids_; // edge ids of heads smaller than the tail, in order of their positions
+   std::vector<EDGE_INFORMATION> edges_; // edge information indexed by edge id
+};
+
+} // end namespace LP_MP
+
+#endif // LP_MP_CSR_GRAPH_HXX
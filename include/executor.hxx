@@ -0,0 +1,257 @@
+#ifndef LP_MP_EXECUTOR_HXX
+#define LP_MP_EXECUTOR_HXX
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <cassert>
+#include "config.hxx"
+
+#ifdef LP_MP_PARALLEL
+#include <omp.h>
+#endif
+
+namespace LP_MP {
+
+// backends running the parallel parts of LP_MP. Applications that own threads already can pass their own executor, possibly shared by several solvers, instead of letting OpenMP start additional threads.
+class executor {
+public:
+   virtual ~executor() {}
+
+   // number of tasks that may run concurrently
+   virtual INDEX no_threads() const = 0;
+
+   // call f(t) for t=0,...,no_tasks-1 and return when all calls have finished.
+   // Calls may run concurrently and in any order. They must not wait for each other, since an executor may run them one after another.
+   // The first exception thrown by a call is rethrown after all calls have finished.
+   virtual void run(const INDEX no_tasks, const std::function<void(INDEX)>& f) = 0;
+};
+
+class sequential_executor : public executor {
+public:
+   INDEX no_threads() const final { return 1; }
+   void run(const INDEX no_tasks, const std::function<void(INDEX)>& f) final
+   {
+      std::exception_ptr error;
+      for(INDEX t=0; t<no_tasks; ++t) {
+         try { f(t); }
+         catch(...) { if(!error) { error = std::current_exception(); } }
+      }
+      if(error) { std::rethrow_exception(error); }
+   }
+};
+
+#ifdef LP_MP_PARALLEL
+// with at most no_threads() tasks and a full team, task t runs on OpenMP thread t, so that thread local settings like numa pinning apply to the same tasks in every call.
+class openmp_executor : public executor {
+public:
+   openmp_executor(const INDEX no_threads) : no_threads_(no_threads) { assert(no_threads > 0); }
+
+   INDEX no_threads() const final { return no_threads_; }
+
+   void run(const INDEX no_tasks, const std::function<void(INDEX)>& f) final
+   {
+      if(no_tasks <= 1) {
+         sequential_executor().run(no_tasks, f);
+         return;
+      }
+      std::exception_ptr error;
+      std::mutex error_mutex;
+      auto call = [&](const INDEX t) {
+         try { f(t); }
+         catch(...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if(!error) { error = std::current_exception(); }
+         }
+      };
+      if(no_tasks <= no_threads_) {
+         // the team may have fewer threads than requested, e.g. when nested, under OMP_THREAD_LIMIT or with dynamic adjustment. Remaining tasks go to threads round robin.
+#pragma omp parallel num_threads(no_tasks)
+         for(INDEX t=omp_get_thread_num(); t<no_tasks; t+=omp_get_num_threads()) { call(t); }
+      } else {
+#pragma omp parallel for schedule(dynamic,1) num_threads(no_threads_)
+         for(INDEX t=0; t<no_tasks; ++t) { call(t); }
+      }
+      if(error) { std::rethrow_exception(error); }
+   }
+
+private:
+   const INDEX no_threads_;
+};
+#endif
+
+// executor that hands jobs to other threads through submit().
+// Tasks are claimed from a shared counter by the calling thread and by up to no_threads()-1 submitted helper jobs.
+// The caller works on the tasks itself and only waits for tasks already started, hence run neither deadlocks when called from a thread of the backend nor when helper jobs start late.
+class submitting_executor : public executor {
+public:
+   void run(const INDEX no_tasks, const std::function<void(INDEX)>& f) final
+   {
+      if(no_tasks <= 1 || no_threads() <= 1) {
+         sequential_executor().run(no_tasks, f);
+         return;
+      }
+      auto batch = std::make_shared<task_batch>(no_tasks, f);
+      const INDEX no_helpers = std::min(no_tasks, no_threads()) - 1;
+      for(INDEX h=0; h<no_helpers; ++h) {
+         submit([batch]() { batch->work(); });
+      }
+      batch->work();
+      batch->wait();
+   }
+
+protected:
+   // run job on some thread other than the calling one
+   virtual void submit(std::function<void()> job) = 0;
+
+private:
+   struct task_batch {
+      task_batch(const INDEX n, const std::function<void(INDEX)>& func) : no_tasks(n), f(func) {}
+
+      // f is only called for claimed tasks, while run still waits for them, hence the reference to it is valid there
+      void work()
+      {
+         for(INDEX t = next++; t < no_tasks; t = next++) {
+            try { f(t); }
+            catch(...) {
+               std::lock_guard<std::mutex> lock(mutex);
+               if(!error) { error = std::current_exception(); }
+            }
+            if(++done == no_tasks) {
+               std::lock_guard<std::mutex> lock(mutex);
+               cv.notify_all();
+            }
+         }
+      }
+
+      void wait()
+      {
+         std::unique_lock<std::mutex> lock(mutex);
+         cv.wait(lock, [this]() { return done == no_tasks; });
+         if(error) { std::rethrow_exception(error); }
+      }
+
+      const INDEX no_tasks;
+      const std::function<void(INDEX)>& f;
+      std::atomic<INDEX> next{0};
+      std::atomic<INDEX> done{0};
+      std::mutex mutex;
+      std::condition_variable cv;
+      std::exception_ptr error;
+   };
+};
+
+// fixed pool of no_threads-1 worker threads, the thread calling run is the remaining one.
+// One pool can be shared by several solvers, concurrent calls of run are served in the order they submit jobs.
+class thread_pool_executor : public submitting_executor {
+public:
+   thread_pool_executor(const INDEX no_threads)
+   : no_threads_(no_threads)
+   {
+      assert(no_threads > 0);
+      for(INDEX i=0; i+1<no_threads; ++i) {
+         workers_.emplace_back([this]() { work_loop(); });
+      }
+   }
+
+   thread_pool_executor(const thread_pool_executor&) = delete;
+   thread_pool_executor& operator=(const thread_pool_executor&) = delete;
+
+   ~thread_pool_executor()
+   {
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         stop_ = true;
+      }
+      cv_.notify_all();
+      for(auto& w : workers_) { w.join(); }
+   }
+
+   INDEX no_threads() const final { return no_threads_; }
+
+protected:
+   void submit(std::function<void()> job) final
+   {
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         jobs_.push_back(std::move(job));
+      }
+      cv_.notify_one();
+   }
+
+private:
+   void work_loop()
+   {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while(true) {
+         cv_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+         if(jobs_.empty()) { assert(stop_); return; }
+         auto job = std::move(jobs_.front());
+         jobs_.pop_front();
+         lock.unlock();
+         job();
+         lock.lock();
+      }
+   }
+
+   const INDEX no_threads_;
+   std::deque<std::function<void()>> jobs_;
+   bool stop_ = false;
+   std::mutex mutex_;
+   std::condition_variable cv_;
+   std::vector<std::thread> workers_;
+};
+
+// executor backed by threads of the application: submit must arrange for the job to be called once on one of them, e.g. by posting it to the application's thread pool.
+// no_threads is the number of threads LP_MP may occupy at the same time, including the calling one.
+class callback_executor : public submitting_executor {
+public:
+   using submit_function = std::function<void(std::function<void()>)>;
+
+   callback_executor(const INDEX no_threads, submit_function submit)
+   : no_threads_(no_threads), submit_(std::move(submit))
+   { assert(no_threads > 0); }
+
+   INDEX no_threads() const final { return no_threads_; }
+
+protected:
+   void submit(std::function<void()> job) final { submit_(std::move(job)); }
+
+private:
+   const INDEX no_threads_;
+   const submit_function submit_;
+};
+
+// executor used where none is given explicitly: OpenMP with its default number of threads in parallel builds, sequential otherwise
+inline executor& default_executor()
+{
+#ifdef LP_MP_PARALLEL
+   static openmp_executor e(omp_get_max_threads());
+#else
+   static sequential_executor e;
+#endif
+   return e;
+}
+
+// call f(i) for i=0,...,n-1, split into one contiguous block of indices per thread
+template<typename FUNC>
+void parallel_for(executor& e, const INDEX n, FUNC f)
+{
+   const INDEX no_tasks = std::min(n, e.no_threads());
+   e.run(no_tasks, [&](const INDEX t) {
+         for(INDEX i=(t*n)/no_tasks; i<((t+1)*n)/no_tasks; ++i) {
+            f(i);
+         }
+   });
+}
+
+} // end namespace LP_MP
+
+#endif // LP_MP_EXECUTOR_HXX
@@ -266,7 +266,7 @@ public:
 
       assert(this->min() == *std::min_element(this->begin(), this->end()));
       if(has_implicit_origin()) {
-         return std::min(0.0, this->min());
+         return std::min(REAL(0.0), this->min());
          //return std::min(0.0, *std::min_element(this->begin(), this->end()));
       } else {
          return this->min();
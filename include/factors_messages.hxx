@@ -25,6 +25,8 @@
 #include "MemoryPool.h"
 
 #include "memory_allocator.hxx"
+#include "spinlock.hxx"
+#include "profiling.hxx"
 
 #include "LP_MP.h"
 
@@ -42,6 +44,17 @@
 
 namespace LP_MP {
 
+#ifdef LP_MP_PARALLEL
+// lock held on a factor while it is updated or receives messages in parallel passes. Chosen at compile time:
+// LP_MP_FACTOR_SPINLOCK: 4 byte reentrant spinlock, no kernel transitions.
+// Locks must be reentrant: a factor holds its own lock while sending, and several of its messages may go to the same adjacent factor.
+#if defined(LP_MP_FACTOR_SPINLOCK)
+using factor_mutex = recursive_spinlock;
+#else
+using factor_mutex = std::recursive_mutex;
+#endif
+#endif
+
 // we must check existence of functions in message classes. The necessary test code is concentrated here. 
 namespace FunctionExistence {
 
@@ -718,7 +731,7 @@ public:
    void send_message_to_left_synchronized(RightFactorType* r, const REAL omega)
    {
      auto& mtx = GetLeftFactor()->mutex_;
-     std::unique_lock<std::recursive_mutex> lck(mtx,std::defer_lock);
+     std::unique_lock<factor_mutex> lck(mtx,std::defer_lock);
      if(lck.try_lock()) {
        msg_op_.send_message_to_left(*r, *static_cast<MessageContainerView<MessageContainerType,Chirality::right>*>(this), omega); 
      } else {
@@ -779,7 +792,7 @@ public:
    void send_message_to_right_synchronized(LeftFactorType* l, const REAL omega)
    {
      auto& mtx = GetRightFactor()->mutex_;
-     std::unique_lock<std::recursive_mutex> lck(mtx,std::defer_lock);
+     std::unique_lock<factor_mutex> lck(mtx,std::defer_lock);
      if(lck.try_lock()) {
        msg_op_.send_message_to_right(*l, *static_cast<MessageContainerView<MessageContainerType,Chirality::left>*>(this), omega); 
      } else {
@@ -1070,6 +1083,7 @@ public:
    template<typename RIGHT_FACTOR, typename MSG_ITERATOR>
    static void SendMessagesToLeftContainer(const RIGHT_FACTOR& rightFactor, MSG_ITERATOR msgs_begin, MSG_ITERATOR msgs_end, const REAL omega) 
    {
+      LP_MP_PROFILE_MESSAGE(MESSAGE_NO, "SendMessagesToLeftContainer", sizeof(RIGHT_FACTOR) + std::distance(msgs_begin, msgs_end)*sizeof(MessageContainerType))
 #ifndef NDEBUG
        test_send_messages_to_left(msgs_begin, msgs_end);
 #endif
@@ -1180,6 +1194,7 @@ public:
    template<typename LEFT_FACTOR, typename MSG_ITERATOR>
    static void SendMessagesToRightContainer(const LEFT_FACTOR& leftFactor, MSG_ITERATOR msgs_begin, MSG_ITERATOR msgs_end, const REAL omega) 
    {
+      LP_MP_PROFILE_MESSAGE(MESSAGE_NO, "SendMessagesToRightContainer", sizeof(LEFT_FACTOR) + std::distance(msgs_begin, msgs_end)*sizeof(MessageContainerType))
 #ifndef NDEBUG
        test_send_messages_to_right(msgs_begin, msgs_end);
 #endif
@@ -1381,6 +1396,8 @@ public:
    RepamLeft(const ARRAY& m)
    { 
       //assert(false); // no -+ distinguishing
+      leftFactor_->invalidate_lower_bound();
+      leftFactor_->add_received_change(m);
       if constexpr(CanBatchRepamLeft<ARRAY>()) {
             msg_op_.RepamLeft(*(leftFactor_->GetFactor()), m);
       } else {
@@ -1412,6 +1429,8 @@ public:
    //typename std::enable_if<IsAssignable == true>::type
    void
    RepamLeft(const REAL diff, const INDEX dim) {
+      leftFactor_->invalidate_lower_bound();
+      leftFactor_->add_received_change(diff);
       msg_op_.RepamLeft(*(leftFactor_->GetFactor()), diff, dim); // note: in right, we reparametrize by +diff, here by -diff
    }
    /*
@@ -1435,6 +1454,8 @@ public:
    RepamRight(const ARRAY& m)
    { 
       //assert(false); // no -+ distinguishing
+      rightFactor_->invalidate_lower_bound();
+      rightFactor_->add_received_change(m);
       if constexpr(CanBatchRepamRight<ARRAY>()) {
             msg_op_.RepamRight(*(rightFactor_->GetFactor()), m);
       } else {
@@ -1466,6 +1487,8 @@ public:
    //typename std::enable_if<IsAssignable == true>::type
    void
    RepamRight(const REAL diff, const INDEX dim) {
+      rightFactor_->invalidate_lower_bound();
+      rightFactor_->add_received_change(diff);
       msg_op_.RepamRight(*(rightFactor_->GetFactor()), diff, dim);
    }
    /*
@@ -2249,12 +2272,15 @@ public:
 
    void update_factor_uniform(const REAL leave_weight) final
    {
+       invalidate_lower_bound();
        receive_messages();
        MaximizePotential();
        send_messages(leave_weight);
    }
    void UpdateFactor(const weight_slice omega, const receive_slice receive_mask) final
    {
+      LP_MP_PROFILE_FACTOR(FACTOR_NO, "UpdateFactor", sizeof(FactorContainerType))
+      invalidate_lower_bound();
       ReceiveMessages(receive_mask);
       MaximizePotential();
       SendMessages(omega);
@@ -2262,6 +2288,7 @@ public:
 
    void update_factor_adaptive(const weight_slice omega, const receive_slice receive_mask) final
    {
+      invalidate_lower_bound();
       ReceiveMessages(receive_mask);
       MaximizePotential();
       send_messages_with_adaptive_weights(omega); 
@@ -2273,6 +2300,7 @@ public:
       assert(*std::max_element(omega.begin(), omega.end()) <= 1.0+eps);
       assert(std::distance(omega.begin(), omega.end()) == no_send_messages());
       assert(receive_mask.size() == no_receive_messages());
+      invalidate_lower_bound();
       ReceiveMessages(receive_mask);
       MaximizePotential();
       send_messages_residual(omega); // other message passing type shall be called "shared"
@@ -2284,7 +2312,7 @@ public:
       assert(*std::min_element(omega.begin(), omega.end()) >= 0.0);
       assert(std::accumulate(omega.begin(), omega.end(), 0.0) <= 1.0 + eps);
       assert(std::distance(omega.begin(), omega.end()) == no_send_messages());
-      std::lock_guard<std::recursive_mutex> lock(mutex_); // only here do we wait for the mutex. In all other places try_lock is allowed only
+      std::lock_guard<factor_mutex> lock(mutex_); // only here do we wait for the mutex. In all other places try_lock is allowed only
       ReceiveMessagesSynchronized(omega);
       MaximizePotential();
       SendMessagesSynchronized(omega);
@@ -2332,9 +2360,10 @@ public:
    void UpdateFactorPrimal(const weight_slice& omega, const receive_slice& receive_mask, INDEX primal_access) final
    {
 #ifdef LP_MP_PARALLEL
-     std::lock_guard<std::recursive_mutex> lock(mutex_); // only here do we wait for the mutex. In all other places try_lock is allowed only
+     std::lock_guard<factor_mutex> lock(mutex_); // only here do we wait for the mutex. In all other places try_lock is allowed only
 #endif
       assert(primal_access > 0); // otherwise primal is not initialized in first iteration
+      invalidate_lower_bound();
       conditionally_init_primal(primal_access);
       if(CanComputePrimal()) { // do zrobienia: for now
          primal_access_ = primal_access;
@@ -2440,6 +2469,7 @@ public:
    template<typename WEIGHT_VEC>
    void ReceiveMessages(const WEIGHT_VEC& receive_mask) 
    {
+      LP_MP_PROFILE_FACTOR(FACTOR_NO, "ReceiveMessages", sizeof(FactorContainerType))
       assert(std::distance(receive_mask.begin(), receive_mask.end()) == no_receive_messages()); 
       assert(receive_mask.size() == 0 || *std::max_element(receive_mask.begin(), receive_mask.end()) <= 1);
       assert(receive_mask.size() == 0 || *std::min_element(receive_mask.begin(), receive_mask.end()) >= 0);
@@ -2787,6 +2817,7 @@ public:
    template<typename WEIGHT_VEC>
    void SendMessages(const WEIGHT_VEC& omega) 
    {
+      LP_MP_PROFILE_FACTOR(FACTOR_NO, "SendMessages", sizeof(FactorContainerType))
       assert(*std::min_element(omega.begin(), omega.end()) >= 0.0);
       assert(std::accumulate(omega.begin(), omega.end(), 0.0) <= 1.0 + eps);
       assert(std::distance(omega.begin(), omega.end()) == no_send_messages()); 
@@ -3194,7 +3225,7 @@ public:
    }
 
    virtual void serialize_dual(load_archive& ar) final
-   { factor_.serialize_dual(ar); }
+   { invalidate_lower_bound(); factor_.serialize_dual(ar); }
    virtual void serialize_primal(load_archive& ar) final
    { factor_.serialize_primal(ar); } 
    virtual void serialize_dual(save_archive& ar) final
@@ -3206,7 +3237,7 @@ public:
    virtual void serialize_primal(allocate_archive& ar) final
    { factor_.serialize_primal(ar); } 
    virtual void serialize_dual(addition_archive& ar) final
-   { factor_.serialize_dual(ar); }
+   { invalidate_lower_bound(); factor_.serialize_dual(ar); }
 
    // returns size in bytes
    virtual INDEX dual_size() final
@@ -3224,6 +3255,7 @@ public:
 
    virtual void divide(const REAL val) final
    {
+      invalidate_lower_bound();
       arithmetic_archive<operation::division> ar(val);
       factor_.serialize_dual(ar);
    }
@@ -3232,6 +3264,7 @@ public:
    {
        assert(dynamic_cast<FactorContainer*>(other) != nullptr);
        auto* o = static_cast<FactorContainer*>(other);
+       invalidate_lower_bound();
        auto vars = factor_.export_variables();
        auto other_vars = o->GetFactor()->export_variables();
        for_each_tuple_pair(vars, other_vars, [](auto& var_1, auto& var_2) { var_1 += var_2; });
@@ -3249,6 +3282,52 @@ public:
       return factor_.LowerBound(); 
    } 
 
+   // lower bound is recomputed only if the factor was reparametrized since the last call.
+   // Changes made directly to factor_ through GetFactor() are not tracked, call invalidate_lower_bound() after those.
+   REAL lower_bound_cached() final
+   {
+      if(!lower_bound_valid_) {
+         lower_bound_ = LowerBound();
+         lower_bound_valid_ = true;
+      }
+      return lower_bound_;
+   }
+   bool lower_bound_valid() const final { return lower_bound_valid_; }
+   void invalidate_lower_bound() final { lower_bound_valid_ = false; }
+
+   void track_received_change(const bool track) final { track_received_change_ = track; received_change_ = 0.0; }
+   REAL received_change() const final { return received_change_; }
+   void reset_received_change() final { received_change_ = 0.0; }
+   // called by messages whenever they reparametrize this factor, hence not virtual
+   template<typename ARRAY>
+   void add_received_change(const ARRAY& m)
+   {
+      if(track_received_change_) {
+         const auto s = m.size();
+         for(INDEX i=0; i<s; ++i) { received_change_ += std::abs(m[i]); }
+      }
+   }
+   void add_received_change(const REAL diff)
+   {
+      if(track_received_change_) { received_change_ += std::abs(diff); }
+   }
+
+   // pages of the container, which holds the pointers to messages, and of the dual memory. The messages themselves are shared with the adjacent factor and not included.
+   void numa_pages(std::vector<void*>& pages) final
+   {
+      numa_add_pages(this, sizeof(FactorContainerType), pages);
+      numa_page_archive ar(pages);
+      factor_.serialize_dual(ar);
+   }
+
+   // the factor is rebuilt from a copy, so that memory it allocates is taken from the top of the arena. Messages only refer to the container and stay valid.
+   void relocate_dual() final
+   {
+      FactorType relocated(factor_);
+      factor_.~FactorType();
+      new(&factor_) FactorType(std::move(relocated));
+   }
+
    REAL EvaluatePrimal() const final
    {
       return factor_.EvaluatePrimal();
@@ -3292,6 +3371,10 @@ public:
    
 protected:
    FactorType factor_; // the factor operation
+   REAL lower_bound_ = 0.0;
+   bool lower_bound_valid_ = false;
+   bool track_received_change_ = false;
+   REAL received_change_ = 0.0;
 public:
    INDEX primal_access_ = 0; // counts when primal was accessed last, do zrobienia: make setter and getter for clean interface or make MessageContainer a friend
 
@@ -3431,7 +3514,7 @@ private:
 #ifdef LP_MP_PARALLEL
    // a recursive mutex is required only for SendMessagesTo{Left|Right}, as multiple messages may be have the same endpoints. Then the corresponding lock is acquired multiple times.
    // if no two messages have the same endpoints, an ordinary mutex is enough.
-   std::recursive_mutex mutex_;
+   factor_mutex mutex_;
 #endif
 
 public:
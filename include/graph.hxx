@@ -5,12 +5,73 @@
 #include <array>
 #include <algorithm>
 #include <queue>
+#include <deque>
+#include <atomic>
+#include <numeric>
+#include <tuple>
+#include <cstdint>
+#include <memory>
 #include "two_dimensional_variable_array.hxx"
+#include "executor.hxx"
 #include "union_find.hxx"
 #include "help_functions.hxx"
 
 namespace LP_MP {
 
+    template<std::size_t N>
+    struct weighted_cycle {
+        std::array<std::size_t,N> nodes;
+        double weight;
+    };
+
+    // bounded collection of the k cycles of largest weight
+    template<std::size_t N>
+    class top_k_cycles {
+    public:
+        top_k_cycles(const std::size_t k) : k_(k) {}
+
+        void push(const weighted_cycle<N>& c)
+        {
+            if(k_ == 0) { return; }
+            if(heap_.size() < k_) {
+                heap_.push_back(c);
+                std::push_heap(heap_.begin(), heap_.end(), better);
+            } else if(better(c, heap_.front())) {
+                std::pop_heap(heap_.begin(), heap_.end(), better);
+                heap_.back() = c;
+                std::push_heap(heap_.begin(), heap_.end(), better);
+            }
+        }
+
+        // k best cycles of all collections, sorted by decreasing weight
+        static std::vector<weighted_cycle<N>> merge(const std::vector<top_k_cycles>& collections, const std::size_t k)
+        {
+            std::vector<weighted_cycle<N>> cycles;
+            for(const auto& c : collections) { cycles.insert(cycles.end(), c.heap_.begin(), c.heap_.end()); }
+            std::sort(cycles.begin(), cycles.end(), better);
+            if(cycles.size() > k) { cycles.resize(k); }
+            return cycles;
+        }
+
+    private:
+        // the heap's front is the worst cycle kept
+        static bool better(const weighted_cycle<N>& c1, const weighted_cycle<N>& c2)
+        {
+            return c1.weight > c2.weight || (c1.weight == c2.weight && c1.nodes < c2.nodes);
+        }
+
+        std::size_t k_;
+        std::vector<weighted_cycle<N>> heap_;
+    };
+
+    // how neighbourhoods of the endpoints of an edge are intersected when enumerating triangles.
+    // adaptive tests neighbours of j against a bitset of the neighbours of i unless i has very few neighbours, gallops through the larger neighbourhood if the other one is much smaller and merges otherwise.
+    enum class triangle_intersection_kernel { adaptive, merge, galloping, bitset };
+    // a neighbourhood is this many times larger than the other one before it is searched by galloping instead of merging
+    constexpr std::size_t triangle_galloping_ratio = 32;
+    // nodes of at least this degree get a bitset of their neighbours, against which neighbourhoods of their neighbours are tested. Setting and clearing it is cheap compared to the intersections it serves.
+    constexpr std::size_t triangle_bitset_min_degree = 8;
+
 	// possibly templatize for support for sister pointers and masking edges out
 	template<typename EDGE_INFORMATION, bool SUPPORT_SISTER=true, bool SUPPORT_MASKING=false>
 	class graph {
@@ -168,45 +229,43 @@ namespace LP_MP {
 		auto end(const std::size_t i) const { return edges_[i].end(); }
 
 		// enumerate all triangles and call f on each. f expects the three node indices (i<j<k) of triangles (sorted) and references to edges in lexicographical order (ij,ik,jk)
+		// Neighbourhoods are intersected by merging, galloping or against a bitset of the neighbours of i, see triangle_intersection_kernel.
 		template<typename LAMBDA>
-		void for_each_triangle(LAMBDA f) const
+		void for_each_triangle(LAMBDA f, const triangle_intersection_kernel kernel = triangle_intersection_kernel::adaptive) const
 		{
-			struct triangle_intersection_type {
-				triangle_intersection_type(std::size_t _k, const edge_type* _ik, const edge_type* _jk) : k(_k), ik(_ik), jk(_jk) {}
-				std::size_t k;
-				const edge_type* ik;
-				const edge_type* jk;
-			};
-			auto edge_intersection_merge = [](const edge_type& e1, const edge_type& e2) -> triangle_intersection_type { 
-				assert(e1.head() == e2.head());
-				const auto k = e1.head();
-				return triangle_intersection_type(k, &e1, &e2);
-			};
-			auto edge_intersection_sort = [](const edge_type& e1, const edge_type& e2) { return e1.head() < e2.head(); };
-
-			std::vector<triangle_intersection_type> common_nodes;
+			triangle_intersection_buffer buffer;
 			for(std::size_t i=0; i<no_nodes(); ++i) {
-				for(auto edge_it=begin(i); edge_it!=end(i); ++edge_it) {
-					const auto j = edge_it->head();
-					if(i<j) {
-						// Now find all neighbors of both i and j to see where the triangles are
-						common_nodes.clear();
-						auto intersects_iter_end = set_intersection_merge(
-								edges_[i].begin(), edges_[i].end(), edges_[j].begin(), edges_[j].end(),
-							       	std::back_inserter(common_nodes), edge_intersection_sort, edge_intersection_merge);
-
-						for(const triangle_intersection_type t : common_nodes) {
-							const auto k = t.k;
-
-							// Since a triplet shows up three times as an edge plus a node, we only consider it for the case when i<j<k 
-							if(!(j<k)) { continue; }
+				triangles_of_node(i, buffer, kernel, f);
+			}
+		}
 
-							assert(t.ik->tail() == i && t.jk->tail() == j);
-							f(i,j,k, *edge_it, *(t.ik), *(t.jk));
-						}
+		// parallel enumeration of triangles. Nodes i are distributed in chunks onto the threads of the executor, each thread has its own intersection buffer.
+		// f is called concurrently and additionally expects the thread number first, e.g. for writing into per thread output without locking.
+		template<typename LAMBDA>
+		void for_each_triangle(executor& e, LAMBDA f, const triangle_intersection_kernel kernel = triangle_intersection_kernel::adaptive) const
+		{
+			for_each_node_chunk(e, [&](const std::size_t thread, auto& next_chunk) {
+				triangle_intersection_buffer buffer;
+				for(auto [chunk_begin, chunk_end] = next_chunk(); chunk_begin<chunk_end; std::tie(chunk_begin, chunk_end) = next_chunk()) {
+					for(std::size_t i=chunk_begin; i<chunk_end; ++i) {
+						triangles_of_node(i, buffer, kernel, [&](const std::size_t i, const std::size_t j, const std::size_t k, const edge_type& ij, const edge_type& ik, const edge_type& jk) {
+							f(thread, i,j,k, ij,ik,jk);
+						});
 					}
 				}
-			}
+			});
+		}
+
+		// the at most k triangles with largest weight(i,j,k,ij,ik,jk), e.g. the most violated cycle inequalities, sorted by decreasing weight.
+		// Every thread keeps its k best triangles only. Ties are broken by node indices, hence the result does not depend on the number of threads.
+		template<typename WEIGHT_FUNC>
+		std::vector<weighted_cycle<3>> top_k_triangles(executor& e, const std::size_t k, WEIGHT_FUNC weight) const
+		{
+			std::vector<top_k_cycles<3>> best(e.no_threads(), top_k_cycles<3>(k));
+			for_each_triangle(e, [&](const std::size_t thread, const std::size_t i, const std::size_t j, const std::size_t l, const edge_type& ij, const edge_type& il, const edge_type& jl) {
+				best[thread].push({{i,j,l}, weight(i,j,l, ij,il,jl)});
+			});
+			return top_k_cycles<3>::merge(best, k);
 		}
 
 		template<typename ENDPOINT_ITERATOR, typename LAMBDA>
@@ -225,7 +284,8 @@ namespace LP_MP {
 				node_degrees[i].i = i;
 				node_degrees[i].degree = no_edges(i);
 			}
-			std::sort(node_degrees.begin(), node_degrees.end(), [](const node_degree& n1, const node_degree& n2) { return n1.degree > n2.degree; });
+			// ties are broken by node index, so that the parallel for_each_quadrangle processes nodes in the same order
+			std::sort(node_degrees.begin(), node_degrees.end(), [](const node_degree& n1, const node_degree& n2) { return n1.degree > n2.degree || (n1.degree == n2.degree && n1.i < n2.i); });
 
 			// structure for recording masked edges
 			two_dim_variable_array<unsigned char> edge_mask(edges_.size_begin(), edges_.size_end());
@@ -275,6 +335,61 @@ namespace LP_MP {
 			}
 		}
 
+		// parallel enumeration of the same quadrangles (v,w,u1,u2) as for_each_quadrangle, up to the order of calls and of u1,u2: when node v is processed there, edges to nodes processed earlier are masked.
+		// Hence v and w of a quadrangle are determined by the node order alone (decreasing degree, ties broken by index in both versions), and all nodes can be processed independently with per thread buffers.
+		// Instead of one list U[w] per node, each thread collects the 2-paths (w,u) of v in one reused buffer and groups them by sorting, so its memory is proportional to the 2-hop neighbourhood and not to the number of nodes.
+		// f is called concurrently and additionally expects the thread number first.
+		template<typename LAMBDA>
+		void for_each_quadrangle(executor& e, LAMBDA f) const
+		{
+			// position of nodes in order of decreasing degree, ties broken by index as in for_each_quadrangle
+			std::vector<std::size_t> order(no_nodes());
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [&](const std::size_t i, const std::size_t j) { return no_edges(i) > no_edges(j) || (no_edges(i) == no_edges(j) && i < j); });
+			std::vector<std::size_t> rank(no_nodes());
+			for(std::size_t r=0; r<order.size(); ++r) { rank[order[r]] = r; }
+
+			for_each_node_chunk(e, [&](const std::size_t thread, auto& next_chunk) {
+				std::vector<std::array<std::size_t,2>> paths; // (w,u) for 2-paths v-u-w
+				for(auto [chunk_begin, chunk_end] = next_chunk(); chunk_begin<chunk_end; std::tie(chunk_begin, chunk_end) = next_chunk()) {
+					for(std::size_t v=chunk_begin; v<chunk_end; ++v) {
+						for(auto uv=begin(v); uv!=end(v); ++uv) {
+							const std::size_t u = uv->head();
+							if(rank[u] < rank[v]) { continue; }
+							for(auto uw=begin(u); uw!=end(u); ++uw) {
+								const std::size_t w = uw->head();
+								if(w == v || rank[w] < rank[v]) { continue; }
+								paths.push_back({w,u});
+							}
+						}
+						std::sort(paths.begin(), paths.end());
+						for(std::size_t group_begin=0; group_begin<paths.size();) {
+							const std::size_t w = paths[group_begin][0];
+							std::size_t group_end = group_begin+1;
+							while(group_end < paths.size() && paths[group_end][0] == w) { ++group_end; }
+							for(std::size_t i=group_begin; i<group_end; ++i) {
+								for(std::size_t j=i+1; j<group_end; ++j) {
+									f(thread, v, w, paths[i][1], paths[j][1]);
+								}
+							}
+							group_begin = group_end;
+						}
+						paths.clear();
+					}
+				}
+			});
+		}
+
+		// the at most k quadrangles with largest weight(v,w,u1,u2) of cycle v-u1-w-u2, sorted by decreasing weight. See top_k_triangles.
+		template<typename WEIGHT_FUNC>
+		std::vector<weighted_cycle<4>> top_k_quadrangles(executor& e, const std::size_t k, WEIGHT_FUNC weight) const
+		{
+			std::vector<top_k_cycles<4>> best(e.no_threads(), top_k_cycles<4>(k));
+			for_each_quadrangle(e, [&](const std::size_t thread, const std::size_t v, const std::size_t w, const std::size_t u1, const std::size_t u2) {
+				best[thread].push({{v,w,u1,u2}, weight(v,w,u1,u2)});
+			});
+			return top_k_cycles<4>::merge(best, k);
+		}
 
 		// return contracted graph and mapping from original nodes to contracted nodes
 		template<typename EDGE_ITERATOR, typename MERGE_FUNC>
@@ -359,6 +474,105 @@ namespace LP_MP {
         }
 
         private:
+		struct triangle_intersection_type {
+			triangle_intersection_type(std::size_t _k, const edge_type* _ik, const edge_type* _jk) : k(_k), ik(_ik), jk(_jk) {}
+			std::size_t k;
+			const edge_type* ik;
+			const edge_type* jk;
+		};
+
+		// per thread memory for enumerating triangles
+		struct triangle_intersection_buffer {
+			std::vector<triangle_intersection_type> common_nodes;
+			std::vector<std::uint64_t> neighbours; // bitset of neighbours of the current node i, all zero between nodes
+		};
+
+		// call f on all triangles (i,j,k) with i<j<k
+		// Only neighbours k>j of i and j are intersected, with the kernel chosen for each edge ij by the sizes of these neighbourhoods.
+		template<typename LAMBDA>
+		void triangles_of_node(const std::size_t i, triangle_intersection_buffer& buffer, const triangle_intersection_kernel kernel, LAMBDA&& f) const
+		{
+			auto edge_intersection_merge = [](const edge_type& e1, const edge_type& e2) -> triangle_intersection_type { 
+				assert(e1.head() == e2.head());
+				const auto k = e1.head();
+				return triangle_intersection_type(k, &e1, &e2);
+			};
+			auto edge_intersection_sort = [](const edge_type& e1, const edge_type& e2) { return e1.head() < e2.head(); };
+			auto head_less = [](const std::size_t k, const edge_type& e) { return k < e.head(); };
+
+			const bool use_bitset = kernel == triangle_intersection_kernel::bitset || (kernel == triangle_intersection_kernel::adaptive && no_edges(i) >= triangle_bitset_min_degree);
+			auto& neighbours = buffer.neighbours;
+			if(use_bitset) {
+				neighbours.resize((no_nodes()+63)/64, 0);
+				for(auto edge_it=begin(i); edge_it!=end(i); ++edge_it) {
+					neighbours[edge_it->head()/64] |= std::uint64_t(1) << (edge_it->head()%64);
+				}
+			}
+
+			auto& common_nodes = buffer.common_nodes;
+			for(auto edge_it=begin(i); edge_it!=end(i); ++edge_it) {
+				const auto j = edge_it->head();
+				if(i<j) {
+					// Now find all neighbors k>j of both i and j to see where the triangles are. Since a triplet shows up three times as an edge plus a node, we only consider it for the case when i<j<k
+					const edge_type* i_begin = edge_it+1;
+					const edge_type* i_end = end(i);
+					const edge_type* j_begin = std::upper_bound(begin(j), end(j), j, head_less);
+					const edge_type* j_end = end(j);
+					const std::size_t i_size = i_end - i_begin;
+					const std::size_t j_size = j_end - j_begin;
+
+					common_nodes.clear();
+					if(use_bitset && (kernel == triangle_intersection_kernel::bitset || j_size < triangle_galloping_ratio*i_size)) {
+						for(const edge_type* jk=j_begin; jk!=j_end; ++jk) {
+							const auto k = jk->head();
+							if(neighbours[k/64] & (std::uint64_t(1) << (k%64))) {
+								const edge_type* ik = std::lower_bound(i_begin, i_end, *jk, edge_intersection_sort);
+								assert(ik != i_end && ik->head() == k);
+								common_nodes.push_back(triangle_intersection_type(k, ik, jk));
+							}
+						}
+					} else if(kernel == triangle_intersection_kernel::galloping || (kernel == triangle_intersection_kernel::adaptive && std::max(i_size, j_size) >= triangle_galloping_ratio*std::min(i_size, j_size))) {
+						if(i_size <= j_size) {
+							set_intersection_galloping(i_begin, i_end, j_begin, j_end, std::back_inserter(common_nodes), edge_intersection_sort, edge_intersection_merge);
+						} else {
+							set_intersection_galloping(j_begin, j_end, i_begin, i_end, std::back_inserter(common_nodes), edge_intersection_sort,
+									[&](const edge_type& jk, const edge_type& ik) { return edge_intersection_merge(ik, jk); });
+						}
+					} else {
+						set_intersection_merge(i_begin, i_end, j_begin, j_end, std::back_inserter(common_nodes), edge_intersection_sort, edge_intersection_merge);
+					}
+
+					for(const triangle_intersection_type t : common_nodes) {
+						assert(j < t.k);
+						assert(t.ik->tail() == i && t.jk->tail() == j);
+						f(i,j,t.k, *edge_it, *(t.ik), *(t.jk));
+					}
+				}
+			}
+
+			if(use_bitset) {
+				for(auto edge_it=begin(i); edge_it!=end(i); ++edge_it) {
+					neighbours[edge_it->head()/64] = 0;
+				}
+			}
+		}
+
+		// run f(thread, next_chunk) on every thread of the executor. next_chunk() returns the next range of nodes not yet claimed by any thread, an empty range when all are claimed.
+		// Chunks are small, since work per node varies with its degree.
+		template<typename LAMBDA>
+		void for_each_node_chunk(executor& e, LAMBDA f) const
+		{
+			constexpr std::size_t chunk_size = 64;
+			std::atomic<std::size_t> next(0);
+			e.run(e.no_threads(), [&](const INDEX thread) {
+				auto next_chunk = [&]() {
+					const std::size_t begin = std::min(next.fetch_add(chunk_size), no_nodes());
+					return std::make_pair(begin, std::min(begin + chunk_size, no_nodes()));
+				};
+				f(thread, next_chunk);
+			});
+		}
+
         two_dim_variable_array<edge_type> edges_;
     };
 
@@ -472,7 +686,7 @@ namespace LP_MP {
                     for(auto a_it=g.begin(i); a_it!=g.end(i); ++a_it) { 
                         const std::size_t j = a_it->head();
 
-                        if(mask_op(i,j,*a_it)) {
+                        if(mask_op(i,j,a_it->edge())) {
 
                             if(!labelled(j)) {
                                 visit.push_back({j, distance+1});
@@ -512,6 +726,55 @@ namespace LP_MP {
             return std::vector<std::size_t>({});
         }
 
+        // shortest paths from start_node to all of [target_begin, target_end) by one search. paths[t] is empty if target t is not reachable, otherwise it starts at start_node.
+        // The search stops as soon as all targets are reached.
+        template<typename TARGET_ITERATOR, typename MASK_OP>
+        std::vector<std::vector<std::size_t>> find_paths(const std::size_t start_node, TARGET_ITERATOR target_begin, TARGET_ITERATOR target_end, MASK_OP mask_op)
+        {
+            assert(start_node < g.no_nodes());
+            reset();
+            // targets are labelled 2 until they are reached
+            std::size_t no_targets = 0;
+            for(auto t=target_begin; t!=target_end; ++t) {
+                assert(*t != start_node && *t < g.no_nodes());
+                if(!labelled2(*t)) {
+                    label2(*t);
+                    ++no_targets;
+                }
+            }
+            visit.push_back({start_node, 0});
+            label1(start_node);
+            parent(start_node) = start_node;
+
+            while(!visit.empty() && no_targets > 0) {
+                const std::size_t i = visit.front()[0];
+                const std::size_t distance = visit.front()[1];
+                visit.pop_front();
+
+                for(auto a_it=g.begin(i); a_it!=g.end(i) && no_targets > 0; ++a_it) { 
+                    const std::size_t j = a_it->head();
+                    if(!labelled1(j) && mask_op(i,j,a_it->edge())) {
+                        if(labelled2(j)) { --no_targets; }
+                        visit.push_back({j, distance+1});
+                        d[j].e = a_it->edge();
+                        parent(j) = i;
+                        label1(j);
+                    }
+                }
+            }
+
+            std::vector<std::vector<std::size_t>> paths;
+            for(auto t=target_begin; t!=target_end; ++t) {
+                paths.push_back({});
+                if(!labelled1(*t)) { continue; }
+                auto& path = paths.back();
+                for(std::size_t j=*t; j!=start_node; j=parent(j)) { path.push_back(j); }
+                path.push_back(start_node);
+                std::reverse(path.begin(), path.end());
+            }
+            return paths;
+        }
+
         private:
         std::vector<item> d;
         std::deque<std::array<std::size_t,2>> visit; // node number, distance from start or end 
@@ -519,6 +782,69 @@ namespace LP_MP {
         const GRAPH& g;
     };
 
+    // shortest paths for many node pairs in one call, e.g. to separate violated cycles through all repulsive edges of a multicut at once: the path for edge ij together with ij is a cycle.
+    // Queries with the same first node are answered by a single search from it, queries with a first node of their own by a bidirectional search.
+    // Searches run in parallel on the threads of the executor, every thread has its own bfs_data. The result does not depend on the number of threads.
+    template<typename GRAPH>
+    class bfs_separation {
+    public:
+        bfs_separation(const GRAPH& g, executor& e = default_executor()) : g_(g), e_(e), data_(e.no_threads()) {}
+
+        // path from queries[q][0] to queries[q][1] for every query q such that mask_op holds for all edges on it, or an empty path if there is none.
+        template<typename MASK_OP>
+        std::vector<std::vector<std::size_t>> find_paths(const std::vector<std::array<std::size_t,2>>& queries, MASK_OP mask_op)
+        {
+            // queries grouped by first node
+            std::vector<std::size_t> order(queries.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](const std::size_t q1, const std::size_t q2) { return queries[q1][0] < queries[q2][0]; });
+            std::vector<std::size_t> group_begin;
+            for(std::size_t c=0; c<order.size(); ++c) {
+                if(c == 0 || queries[order[c]][0] != queries[order[c-1]][0]) { group_begin.push_back(c); }
+            }
+            group_begin.push_back(order.size());
+
+            std::vector<std::vector<std::size_t>> paths(queries.size());
+            std::atomic<std::size_t> next_group(0);
+            e_.run(e_.no_threads(), [&](const INDEX thread) {
+                if(!data_[thread]) { data_[thread] = std::make_unique<bfs_data<GRAPH>>(g_); }
+                auto& bfs = *data_[thread];
+                std::vector<std::size_t> targets;
+                for(std::size_t group = next_group++; group+1 < group_begin.size(); group = next_group++) {
+                    const std::size_t source = queries[order[group_begin[group]]][0];
+                    if(group_begin[group+1] - group_begin[group] == 1) {
+                        const std::size_t q = order[group_begin[group]];
+                        auto path = bfs.find_path(source, queries[q][1], mask_op, bfs_data<GRAPH>::no_edge_op);
+                        if(path.size() > 0 && path.front() != source) { std::reverse(path.begin(), path.end()); }
+                        paths[q] = std::move(path);
+                    } else {
+                        targets.clear();
+                        for(std::size_t c=group_begin[group]; c<group_begin[group+1]; ++c) { targets.push_back(queries[order[c]][1]); }
+                        auto group_paths = bfs.find_paths(source, targets.begin(), targets.end(), mask_op);
+                        for(std::size_t c=group_begin[group]; c<group_begin[group+1]; ++c) { paths[order[c]] = std::move(group_paths[c - group_begin[group]]); }
+                    }
+                }
+            });
+            return paths;
+        }
+
+        // cycles made of a query edge and a shortest path between its endpoints, sorted by length and then lexicographically.
+        // Every cycle starts with the first and ends with the second node of its query edge. Queries whose endpoints are not connected give no cycle.
+        template<typename MASK_OP>
+        std::vector<std::vector<std::size_t>> find_cycles(const std::vector<std::array<std::size_t,2>>& queries, MASK_OP mask_op)
+        {
+            auto cycles = find_paths(queries, mask_op);
+            cycles.erase(std::remove_if(cycles.begin(), cycles.end(), [](const auto& c) { return c.empty(); }), cycles.end());
+            std::sort(cycles.begin(), cycles.end(), [](const auto& c1, const auto& c2) { return c1.size() < c2.size() || (c1.size() == c2.size() && c1 < c2); });
+            return cycles;
+        }
+
+    private:
+        const GRAPH& g_;
+        executor& e_;
+        std::vector<std::unique_ptr<bfs_data<GRAPH>>> data_; // one per thread, allocated when first used
+    };
+
 } // namespace LP_MP
 
 #endif // LP_MP_CUT_PACKING_HXX
@@ -0,0 +1,46 @@
+#ifndef LP_MP_GRAPH_COLORING_HXX
+#define LP_MP_GRAPH_COLORING_HXX
+
+#include <vector>
+#include <limits>
+#include <cassert>
+#include "two_dimensional_variable_array.hxx"
+
+namespace LP_MP {
+
+// greedy coloring such that any two colored nodes with distance at most two in the graph get different colors.
+// Only the nodes in [order_begin, order_end) are colored, in this order. The remaining nodes get no color, but still count as intermediate nodes for the distance.
+// Factors in one color class can be updated concurrently: their neighbourhoods, which are written to by message passing, are disjoint.
+template<typename ITERATOR>
+std::vector<std::size_t> distance_two_coloring(const two_dim_variable_array<std::size_t>& adjacency, ITERATOR order_begin, ITERATOR order_end)
+{
+   constexpr static std::size_t no_color = std::numeric_limits<std::size_t>::max();
+   std::vector<std::size_t> color(adjacency.size(), no_color);
+   std::vector<std::size_t> color_forbidden_by; // stores the last node for which the color was forbidden, avoids clearing it for each node
+
+   auto forbid = [&](const std::size_t i, const std::size_t node) {
+      const std::size_t c = color[node];
+      if(c != no_color) { color_forbidden_by[c] = i; }
+   };
+
+   for(auto it=order_begin; it!=order_end; ++it) {
+      const std::size_t i = *it;
+      assert(i < adjacency.size() && color[i] == no_color);
+      for(const std::size_t j : adjacency[i]) {
+         forbid(i,j);
+         for(const std::size_t k : adjacency[j]) {
+            forbid(i,k);
+         }
+      }
+      std::size_t c = 0;
+      while(c < color_forbidden_by.size() && color_forbidden_by[c] == i) { ++c; }
+      if(c == color_forbidden_by.size()) { color_forbidden_by.push_back(no_color); }
+      color[i] = c;
+   }
+
+   return color;
+}
+
+} // end namespace LP_MP
+
+#endif // LP_MP_GRAPH_COLORING_HXX
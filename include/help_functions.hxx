@@ -208,8 +208,30 @@ class InputIt1, class InputIt2, class OutputIt, class Compare, class Merge >
    return d_first;
 }
 
-
-
+// intersection as set_intersection_merge for a range [first1,last1) much shorter than [first2,last2):
+// every element of the short range is searched in the remainder of the long one by exponential followed by binary search, taking O(n1 log(n2/n1)) comparisons.
+template<
+class InputIt1, class InputIt2, class OutputIt, class Compare, class Merge >
+   static OutputIt set_intersection_galloping
+(
+ InputIt1 first1, InputIt1 last1,
+ InputIt2 first2, InputIt2 last2,
+ OutputIt d_first, Compare comp, Merge merge
+ )
+{
+   for(; first1 != last1 && first2 != last2; ++first1)
+   {
+      // find step such that *(first2 + step/2) < *first1 <= *(first2 + step), then search in between
+      std::size_t step = 1;
+      while(step < std::size_t(last2 - first2) && comp(first2[step], *first1))
+         step *= 2;
+      const auto search_end = first2 + std::min(step+1, std::size_t(last2 - first2));
+      first2 = std::lower_bound(first2 + step/2, search_end, *first1, comp);
+      if (first2 != last2 && !comp(*first1, *first2))
+         *d_first++ = merge(*first1, *first2++);
+   }
+   return d_first;
+}
 
 } // end namespace LP_MP
 
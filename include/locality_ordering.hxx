@@ -0,0 +1,76 @@
+#ifndef LP_MP_LOCALITY_ORDERING_HXX
+#define LP_MP_LOCALITY_ORDERING_HXX
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <limits>
+#include <cassert>
+#include "config.hxx"
+
+namespace LP_MP {
+
+// orderings of graph nodes in which adjacent nodes are close to each other, for laying out factors in memory.
+// ADJACENCY is indexable by node and each entry is a range of adjacent nodes, e.g. two_dim_variable_array<INDEX>.
+
+// reverse Cuthill-McKee ordering. Every connected component is traversed breadth first from a node of minimum degree, neighbours are visited by increasing degree.
+// Returns the nodes in their new order.
+template<typename ADJACENCY>
+std::vector<INDEX> reverse_cuthill_mckee(const ADJACENCY& adjacency)
+{
+   const INDEX n = adjacency.size();
+   std::vector<INDEX> degree(n);
+   for(INDEX i=0; i<n; ++i) { degree[i] = std::distance(adjacency[i].begin(), adjacency[i].end()); }
+
+   std::vector<INDEX> nodes_by_degree(n);
+   for(INDEX i=0; i<n; ++i) { nodes_by_degree[i] = i; }
+   std::stable_sort(nodes_by_degree.begin(), nodes_by_degree.end(), [&](const INDEX i, const INDEX j) { return degree[i] < degree[j]; });
+
+   std::vector<INDEX> order;
+   order.reserve(n);
+   std::vector<char> visited(n, 0);
+   std::vector<INDEX> neighbours;
+   for(const INDEX root : nodes_by_degree) {
+      if(visited[root]) { continue; }
+      visited[root] = 1;
+      // order doubles as the breadth first search queue
+      order.push_back(root);
+      for(INDEX head=order.size()-1; head<order.size(); ++head) {
+         neighbours.clear();
+         for(const INDEX j : adjacency[order[head]]) {
+            if(!visited[j]) {
+               visited[j] = 1;
+               neighbours.push_back(j);
+            }
+         }
+         std::stable_sort(neighbours.begin(), neighbours.end(), [&](const INDEX i, const INDEX j) { return degree[i] < degree[j]; });
+         order.insert(order.end(), neighbours.begin(), neighbours.end());
+      }
+   }
+   assert(order.size() == n);
+   std::reverse(order.begin(), order.end());
+   return order;
+}
+
+// maximum distance in the ordering between adjacent nodes. order must be a permutation of all nodes.
+template<typename ADJACENCY>
+INDEX ordering_bandwidth(const ADJACENCY& adjacency, const std::vector<INDEX>& order)
+{
+   assert(order.size() == adjacency.size());
+   std::vector<INDEX> position(order.size(), std::numeric_limits<INDEX>::max());
+   for(INDEX k=0; k<order.size(); ++k) {
+      assert(position[order[k]] == std::numeric_limits<INDEX>::max());
+      position[order[k]] = k;
+   }
+   INDEX bandwidth = 0;
+   for(INDEX i=0; i<adjacency.size(); ++i) {
+      for(const INDEX j : adjacency[i]) {
+         bandwidth = std::max(bandwidth, position[i] > position[j] ? position[i] - position[j] : position[j] - position[i]);
+      }
+   }
+   return bandwidth;
+}
+
+} // end namespace LP_MP
+
+#endif // LP_MP_LOCALITY_ORDERING_HXX
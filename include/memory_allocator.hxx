@@ -6,6 +6,7 @@
 #include <iostream>
 #include <cstring>
 #include <mutex>
+#include <atomic>
 #include "config.hxx"
 #include "spinlock.hxx"
 
@@ -139,6 +140,7 @@ class stack_arena{
 		void* realloc(void * vP, size_t size_bytes);
 		void error_allocate(big_size n, const char * caller);
 		void check_integrity();
+		bool owns(const void * vP);
 	};
 
 //___________________stack_arena___________________________
@@ -615,6 +617,16 @@ template<typename T>
 		return vQ;
    }
 
+	//! whether vP was allocated from one of the buffers. Large blocks allocated by malloc are not recognized
+	inline bool block_arena::owns(const void * vP){
+    std::lock_guard<spinlock> lock(lock_);
+		const int * P = (const int*)vP;
+		for (const auto& b : buffers){
+			if (b.allocated() && P >= b.cap_beg() && P < b.end()) return true;
+      }
+		return false;
+   }
+
 	inline void block_arena::check_integrity(){
 		for (int b = 0; b<buffers.size(); ++b){
 			buffers[b].check_integrity();
@@ -701,6 +713,23 @@ std::array<block_allocator<REAL>, no_stack_allocators> make_block_allocator_arra
 static std::array<block_allocator<REAL>, no_stack_allocators> global_real_block_allocator_array ( make_block_allocator_array(global_real_block_arena_array, std::make_integer_sequence<size_t,no_stack_allocators>{} ) ) ;
 
 static thread_local INDEX stack_allocator_index = 0;
+
+// threads pinned to a NUMA node set stack_allocator_index to their node, so that the buffers of each arena are first touched on one node
+inline block_arena& local_real_block_arena() { return global_real_block_arena_array[stack_allocator_index]; }
+
+// set when threads were pinned to more than one numa node. Before, all threads allocate from the first arena.
+static std::atomic<bool> numa_arenas_active(false);
+
+// memory may be freed by another thread than the one that allocated it. Arenas are searched only when threads use different arenas.
+inline block_arena& owning_real_block_arena(const void* p)
+{
+  if(no_stack_allocators == 1 || !numa_arenas_active.load(std::memory_order_relaxed)) { return global_real_block_arena_array[stack_allocator_index]; }
+  if(global_real_block_arena_array[stack_allocator_index].owns(p)) { return global_real_block_arena_array[stack_allocator_index]; }
+  for(auto& a : global_real_block_arena_array) {
+    if(a.owns(p)) { return a; }
+  }
+  return global_real_block_arena_array[stack_allocator_index]; // large blocks were allocated with malloc and can be freed by any arena
+}
 // do zrobienia: both above allocators do not destroy their arenas
 } // end namespace LP_MP
 
@@ -0,0 +1,119 @@
+#ifndef LP_MP_MODEL_FILE_HXX
+#define LP_MP_MODEL_FILE_HXX
+
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cassert>
+#include "config.hxx"
+#include "serialization.hxx"
+
+namespace LP_MP {
+
+// binary snapshot of a constructed LP from which LP::load_model rebuilds all factors and messages without parsing the original input. Layout:
+//   header | factor types (uint32 per factor) | messages (type, left and right factor as uint64 per message)
+//   | forward and backward pass factor relations (two factors as uint64 per relation) | forward and backward factor ordering (uint64 per factor)
+//   | construction archive (records of factors followed by those of message operations) | dual archive
+// every section starts at a multiple of model_file_alignment, so that the archives can be read in place from a memory mapping.
+constexpr std::uint32_t model_file_version = 1;
+constexpr std::size_t model_file_alignment = 64;
+constexpr char model_file_magic[8] = {'L','P','M','P','M','O','D','L'};
+
+struct model_file_header {
+   char magic[8];
+   std::uint32_t version;
+   std::uint32_t real_size; // sizeof(REAL) when writing, single and double precision archives are not interchangeable
+   std::uint64_t fmc_hash; // hash of FMC::name
+   std::uint64_t no_factors;
+   std::uint64_t no_messages;
+   std::uint64_t no_forward_relations;
+   std::uint64_t no_backward_relations;
+   double constant;
+   std::uint64_t factor_types_offset;
+   std::uint64_t messages_offset;
+   std::uint64_t forward_relations_offset;
+   std::uint64_t backward_relations_offset;
+   std::uint64_t forward_ordering_offset;
+   std::uint64_t backward_ordering_offset;
+   std::uint64_t construction_offset;
+   std::uint64_t construction_size;
+   std::uint64_t dual_offset;
+   std::uint64_t dual_size;
+};
+
+// FNV-1a of FMC::name identifying the problem type of model files and checkpoints, std::hash need not be stable across implementations
+inline std::uint64_t fmc_name_hash(const char* s)
+{
+   std::uint64_t h = 14695981039346656037ull;
+   for(; *s != '\0'; ++s) {
+      h ^= std::uint64_t(static_cast<unsigned char>(*s));
+      h *= 1099511628211ull;
+   }
+   return h;
+}
+
+inline std::uint64_t model_file_align(const std::uint64_t offset)
+{
+   return ((offset + model_file_alignment - 1)/model_file_alignment)*model_file_alignment;
+}
+
+// read-only memory mapping of a model file. Sections are accessed in place without copying.
+class mapped_model_file {
+public:
+   mapped_model_file(const std::string& filename)
+   {
+      fd_ = open(filename.c_str(), O_RDONLY);
+      if(fd_ < 0) { throw std::runtime_error("could not open model file " + filename); }
+      struct stat st;
+      if(fstat(fd_, &st) != 0) { close(fd_); throw std::runtime_error("could not stat model file " + filename); }
+      size_ = st.st_size;
+      if(size_ < sizeof(model_file_header)) { close(fd_); throw std::runtime_error("model file " + filename + " is too short"); }
+      data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+      if(data_ == MAP_FAILED) { close(fd_); throw std::runtime_error("could not map model file " + filename); }
+
+      const auto& h = header();
+      if(std::memcmp(h.magic, model_file_magic, sizeof(model_file_magic)) != 0) { unmap(); throw std::runtime_error(filename + " is not a model file"); }
+      if(h.version != model_file_version) { unmap(); throw std::runtime_error("model file " + filename + " has version " + std::to_string(h.version) + ", expected " + std::to_string(model_file_version)); }
+      if(h.real_size != sizeof(REAL)) { unmap(); throw std::runtime_error("model file " + filename + " was written with different floating point precision"); }
+      if(h.construction_offset + h.construction_size > size_ || h.dual_offset + h.dual_size > size_) { unmap(); throw std::runtime_error("model file " + filename + " is truncated"); }
+   }
+   mapped_model_file(const mapped_model_file&) = delete;
+   mapped_model_file& operator=(const mapped_model_file&) = delete;
+   ~mapped_model_file() { unmap(); }
+
+   const model_file_header& header() const { return *static_cast<const model_file_header*>(data_); }
+
+   template<typename T>
+   const T* section(const std::uint64_t offset) const
+   {
+      assert(offset % model_file_alignment == 0 && offset <= size_);
+      return reinterpret_cast<const T*>(static_cast<const char*>(data_) + offset);
+   }
+
+private:
+   void unmap()
+   {
+      if(data_ != nullptr) { munmap(data_, size_); data_ = nullptr; }
+      if(fd_ >= 0) { close(fd_); fd_ = -1; }
+   }
+
+   int fd_ = -1;
+   std::size_t size_ = 0;
+   void* data_ = nullptr;
+};
+
+// archive reading in place from a section of a mapped model file. The mapping is not freed by it.
+class model_file_archive : public serialization_archive {
+public:
+   model_file_archive(const char* section, const std::uint64_t size) : serialization_archive(section, size) {}
+   ~model_file_archive() { release_memory(); }
+};
+
+} // end namespace LP_MP
+
+#endif // LP_MP_MODEL_FILE_HXX
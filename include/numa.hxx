@@ -0,0 +1,157 @@
+#ifndef LP_MP_NUMA_HXX
+#define LP_MP_NUMA_HXX
+
+#include <array>
+#include <vector>
+#include <bitset>
+#include <cstdint>
+#include <algorithm>
+#include <unistd.h>
+#include "config.hxx"
+#include "vector.hxx"
+#include "serialization.hxx"
+
+// NUMA-aware placement of factors. Compile with -DLP_MP_NUMA and link against libnuma to enable.
+// Without it, there is a single node and all functions below do nothing.
+
+#ifdef LP_MP_NUMA
+#include <numa.h>
+#include <numaif.h>
+#endif
+
+namespace LP_MP {
+
+inline INDEX numa_no_nodes()
+{
+#ifdef LP_MP_NUMA
+   if(numa_available() < 0) { return 1; }
+   return std::max(1, numa_num_configured_nodes());
+#else
+   return 1;
+#endif
+}
+
+// threads t and no_threads-1-t share a node: the static schedule gives thread t the t-th block of the forward and of the backward update ordering, which is approximately the (no_threads-1-t)-th block of the forward ordering.
+// Hence factors placed on the node of their forward thread are also local in the backward pass. Pairs of threads are distributed evenly onto nodes, consecutive pairs share a node.
+inline INDEX numa_thread_node(const INDEX thread_no, const INDEX no_threads, const INDEX no_nodes)
+{
+   assert(thread_no < no_threads && no_nodes > 0);
+   const INDEX pair = std::min(thread_no, no_threads-1-thread_no);
+   return ((2*pair+1)*no_nodes)/(no_threads+1);
+}
+
+// restrict the calling thread to the cpus of its node, see numa_thread_node.
+// returns the node.
+inline INDEX numa_pin_thread(const INDEX thread_no, const INDEX no_threads)
+{
+   const INDEX node = numa_thread_node(thread_no, no_threads, numa_no_nodes());
+#ifdef LP_MP_NUMA
+   if(numa_available() >= 0) {
+      if(numa_run_on_node(node) != 0) {
+         throw std::runtime_error("could not pin thread " + std::to_string(thread_no) + " to numa node " + std::to_string(node));
+      }
+      numa_set_preferred(node);
+   }
+#endif
+   return node;
+}
+
+// append all pages overlapping with [begin, begin+bytes)
+inline void numa_add_pages(const void* begin, const std::size_t bytes, std::vector<void*>& pages)
+{
+   if(bytes == 0) { return; }
+   static const std::uintptr_t page_size = sysconf(_SC_PAGESIZE);
+   const std::uintptr_t first_page = reinterpret_cast<std::uintptr_t>(begin) & ~(page_size-1);
+   const std::uintptr_t last_page = (reinterpret_cast<std::uintptr_t>(begin) + bytes - 1) & ~(page_size-1);
+   for(std::uintptr_t p=first_page; p<=last_page; p+=page_size) {
+      pages.push_back(reinterpret_cast<void*>(p));
+   }
+}
+
+// migrate pages to the given node with a single system call. Pages are sorted and duplicates removed.
+inline void numa_move_pages(std::vector<void*>& pages, const INDEX node)
+{
+   std::sort(pages.begin(), pages.end());
+   pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+#ifdef LP_MP_NUMA
+   if(pages.empty() || numa_available() < 0) { return; }
+   std::vector<int> nodes(pages.size(), int(node));
+   std::vector<int> status(pages.size());
+   // failure is not fatal: pages stay where they are
+   move_pages(0, pages.size(), pages.data(), nodes.data(), status.data(), MPOL_MF_MOVE);
+#endif
+}
+
+// archive that visits the dual memory of a factor like the other archives and collects its pages.
+class numa_page_archive {
+public:
+   numa_page_archive(std::vector<void*>& pages) : pages_(pages) {}
+
+   // for plain data. It lives inside the factor container, which is moved separately
+   template<typename T>
+   typename std::enable_if<std::is_arithmetic<T>::value>::type
+   serialize(const T&) {}
+
+   // for arrays
+   template<typename T>
+   void serialize(const T* pointer, const INDEX size)
+   {
+      numa_add_pages(pointer, sizeof(T)*size, pages_);
+   }
+   template<typename T>
+   void serialize(const binary_data<T> b)
+   {
+      serialize(b.pointer, b.no_elements);
+   }
+
+   // for std::array<T,N>
+   template<typename T, std::size_t N>
+   void serialize(const std::array<T,N>& v)
+   {
+      serialize(v.data(), N);
+   }
+
+   // for vector<T>
+   template<typename T>
+   void serialize(const vector<T>& v)
+   {
+      serialize(v.begin(), v.size());
+   }
+
+   // matrix rows are padded, hence the underlying memory is larger than m.size()
+   template<typename T>
+   void serialize(const matrix<T>& m)
+   {
+      if(m.size() > 0) {
+         serialize(&m(0,0), m.dim1()*m.padded_dim2());
+      }
+   }
+
+   // for std::vector<T>
+   template<typename T>
+   void serialize(const std::vector<T>& v)
+   {
+      serialize(v.data(), v.size());
+   }
+
+   // for std::bitset<N>
+   template<std::size_t N>
+   void serialize(const std::bitset<N>&) {}
+
+   template<typename... T_REST>
+   void operator()(T_REST&&... types)
+   {}
+   template<typename T, typename... T_REST>
+   void operator()(T&& t, T_REST&&... types)
+   {
+      serialize(t);
+      (*this)(types...);
+   }
+
+private:
+   std::vector<void*>& pages_;
+};
+
+} // end namespace LP_MP
+
+#endif // LP_MP_NUMA_HXX
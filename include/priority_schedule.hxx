@@ -0,0 +1,124 @@
+#ifndef LP_MP_PRIORITY_SCHEDULE_HXX
+#define LP_MP_PRIORITY_SCHEDULE_HXX
+
+#include <vector>
+#include <limits>
+#include <cassert>
+#include "config.hxx"
+
+namespace LP_MP {
+
+// binary max-heap over elements 0,...,n-1 whose priorities can be changed while they are in the heap.
+// Elements with priority not above the threshold are not kept, ties are broken towards smaller elements.
+class indexed_priority_queue {
+public:
+   void init(const std::size_t n, const REAL initial_priority, const REAL threshold)
+   {
+      threshold_ = threshold;
+      priority_.assign(n, 0.0);
+      pos_.assign(n, none);
+      heap_.clear();
+      heap_.reserve(n);
+      for(std::size_t i=0; i<n; ++i) {
+         set(i, initial_priority);
+      }
+   }
+
+   bool empty() const { return heap_.empty(); }
+   std::size_t size() const { return heap_.size(); }
+   bool contains(const std::size_t i) const { return pos_[i] != none; }
+
+   std::size_t top() const { assert(!empty()); return heap_[0]; }
+   REAL top_priority() const { assert(!empty()); return priority_[heap_[0]]; }
+
+   // priority of elements not in the queue is zero
+   REAL priority(const std::size_t i) const { return contains(i) ? priority_[i] : 0.0; }
+
+   void pop()
+   {
+      assert(!empty());
+      remove(heap_[0]);
+   }
+
+   // insert, change or remove element i
+   void set(const std::size_t i, const REAL p)
+   {
+      assert(i < pos_.size());
+      if(!(p > threshold_)) {
+         if(contains(i)) { remove(i); }
+         return;
+      }
+      if(!contains(i)) {
+         priority_[i] = p;
+         pos_[i] = heap_.size();
+         heap_.push_back(i);
+         sift_up(pos_[i]);
+      } else {
+         const REAL old = priority_[i];
+         priority_[i] = p;
+         if(p > old) { sift_up(pos_[i]); } else { sift_down(pos_[i]); }
+      }
+   }
+
+private:
+   bool before(const std::size_t i, const std::size_t j) const
+   {
+      return priority_[i] > priority_[j] || (priority_[i] == priority_[j] && i < j);
+   }
+
+   void place(const std::size_t i, const std::size_t p)
+   {
+      heap_[p] = i;
+      pos_[i] = p;
+   }
+
+   void sift_up(std::size_t p)
+   {
+      const std::size_t i = heap_[p];
+      while(p > 0) {
+         const std::size_t parent = (p-1)/2;
+         if(!before(i, heap_[parent])) { break; }
+         place(heap_[parent], p);
+         p = parent;
+      }
+      place(i, p);
+   }
+
+   void sift_down(std::size_t p)
+   {
+      const std::size_t i = heap_[p];
+      while(true) {
+         std::size_t c = 2*p+1;
+         if(c >= heap_.size()) { break; }
+         if(c+1 < heap_.size() && before(heap_[c+1], heap_[c])) { ++c; }
+         if(!before(heap_[c], i)) { break; }
+         place(heap_[c], p);
+         p = c;
+      }
+      place(i, p);
+   }
+
+   void remove(const std::size_t i)
+   {
+      const std::size_t p = pos_[i];
+      assert(p != none);
+      const std::size_t last = heap_.back();
+      heap_.pop_back();
+      pos_[i] = none;
+      if(last != i) {
+         place(last, p);
+         sift_up(p);
+         sift_down(pos_[last]);
+      }
+   }
+
+   constexpr static std::size_t none = std::numeric_limits<std::size_t>::max();
+   REAL threshold_ = 0.0;
+   std::vector<REAL> priority_;
+   std::vector<std::size_t> pos_; // position in heap_ or none
+   std::vector<std::size_t> heap_;
+};
+
+} // end namespace LP_MP
+
+#endif // LP_MP_PRIORITY_SCHEDULE_HXX
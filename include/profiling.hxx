@@ -0,0 +1,122 @@
+#ifndef LP_MP_PROFILING_HXX
+#define LP_MP_PROFILING_HXX
+
+// opt-in instrumentation of factor and message updates. Compile with -DLP_MP_PROFILING to enable.
+// Without it, the LP_MP_PROFILE_* macros expand to nothing.
+
+#ifdef LP_MP_PROFILING
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#if defined(__GNUC__) && ( defined(__i386__) || defined(__x86_64__) )
+#include <x86intrin.h>
+#endif
+
+namespace LP_MP {
+
+struct profiling_counters {
+   std::atomic<std::size_t> calls{0};
+   std::atomic<std::size_t> cycles{0};
+   std::atomic<std::size_t> bytes{0}; // estimate: size of the factor/message objects touched
+};
+
+// counters are registered once per instrumented function and factor/message type and live until program end
+class profiling_registry {
+public:
+   static profiling_registry& get()
+   {
+      static profiling_registry r;
+      return r;
+   }
+
+   // entries with the same name are merged
+   profiling_counters& add(const std::string& name)
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for(auto& e : entries_) {
+         if(e.first == name) { return *e.second; }
+      }
+      entries_.push_back({name, std::make_unique<profiling_counters>()});
+      return *entries_.back().second;
+   }
+
+   void print(std::ostream& s) const
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::vector<const std::pair<std::string, std::unique_ptr<profiling_counters>>*> sorted;
+      for(const auto& e : entries_) { sorted.push_back(&e); }
+      std::sort(sorted.begin(), sorted.end(), [](auto* a, auto* b) { return a->second->cycles > b->second->cycles; });
+
+      s << std::left << std::setw(48) << "profiled function" << std::right << std::setw(14) << "calls" << std::setw(18) << "cycles" << std::setw(14) << "cycles/call" << std::setw(18) << "bytes" << "\n";
+      for(auto* e : sorted) {
+         const std::size_t calls = e->second->calls;
+         const std::size_t cycles = e->second->cycles;
+         s << std::left << std::setw(48) << e->first << std::right << std::setw(14) << calls << std::setw(18) << cycles << std::setw(14) << (calls > 0 ? cycles/calls : 0) << std::setw(18) << e->second->bytes << "\n";
+      }
+   }
+
+   void reset()
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for(auto& e : entries_) {
+         e.second->calls = 0;
+         e.second->cycles = 0;
+         e.second->bytes = 0;
+      }
+   }
+
+private:
+   mutable std::mutex mutex_;
+   std::vector<std::pair<std::string, std::unique_ptr<profiling_counters>>> entries_;
+};
+
+inline std::size_t profiling_cycles()
+{
+#if defined(__GNUC__) && ( defined(__i386__) || defined(__x86_64__) )
+   return __rdtsc();
+#else
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+class profiling_scope {
+public:
+   profiling_scope(profiling_counters& c, const std::size_t bytes) : c_(c), bytes_(bytes), begin_(profiling_cycles()) {}
+   ~profiling_scope()
+   {
+      c_.calls.fetch_add(1, std::memory_order_relaxed);
+      c_.cycles.fetch_add(profiling_cycles() - begin_, std::memory_order_relaxed);
+      c_.bytes.fetch_add(bytes_, std::memory_order_relaxed);
+   }
+private:
+   profiling_counters& c_;
+   const std::size_t bytes_;
+   const std::size_t begin_;
+};
+
+} // end namespace LP_MP
+
+// the function local static makes one counter per template instantiation, i.e. per factor/message container type
+#define LP_MP_PROFILE_SCOPE(NAME, BYTES) \
+   static LP_MP::profiling_counters& lp_mp_profiling_counters_ = LP_MP::profiling_registry::get().add(NAME); \
+   LP_MP::profiling_scope lp_mp_profiling_scope_(lp_mp_profiling_counters_, BYTES);
+#define LP_MP_PROFILE_FACTOR(FACTOR_NO, FUNCTION, BYTES) LP_MP_PROFILE_SCOPE("factor " + std::to_string(FACTOR_NO) + " " + FUNCTION, BYTES)
+#define LP_MP_PROFILE_MESSAGE(MESSAGE_NO, FUNCTION, BYTES) LP_MP_PROFILE_SCOPE("message " + std::to_string(MESSAGE_NO) + " " + FUNCTION, BYTES)
+#define LP_MP_PRINT_PROFILE(STREAM) LP_MP::profiling_registry::get().print(STREAM);
+
+#else
+
+#define LP_MP_PROFILE_FACTOR(FACTOR_NO, FUNCTION, BYTES)
+#define LP_MP_PROFILE_MESSAGE(MESSAGE_NO, FUNCTION, BYTES)
+#define LP_MP_PRINT_PROFILE(STREAM)
+
+#endif // LP_MP_PROFILING
+
+#endif // LP_MP_PROFILING_HXX
@@ -0,0 +1,77 @@
+#ifndef LP_MP_REDUCTION_HXX
+#define LP_MP_REDUCTION_HXX
+
+#include <vector>
+#include <atomic>
+#include <cassert>
+#include "config.hxx"
+#include "executor.hxx"
+
+namespace LP_MP {
+
+// reductions over 0,...,n-1 whose result does not depend on the number of threads:
+// elements are grouped into blocks of fixed size, blocks are evaluated in parallel and their sums are combined pairwise in a fixed order.
+constexpr std::size_t reduction_block_size = 256;
+
+// pairwise sum of partial[begin,end)
+template<typename T>
+T pairwise_sum(const std::vector<T>& partial, const std::size_t begin, const std::size_t end)
+{
+   assert(begin <= end && end <= partial.size());
+   if(end - begin == 0) { return T(0); }
+   if(end - begin == 1) { return partial[begin]; }
+   const std::size_t middle = begin + (end - begin)/2;
+   return pairwise_sum(partial, begin, middle) + pairwise_sum(partial, middle, end);
+}
+
+// sum of value(i) for i=0,...,n-1 accumulated in T
+template<typename T, typename FUNC>
+T deterministic_sum(executor& e, const std::size_t n, FUNC value)
+{
+   const std::size_t no_blocks = (n + reduction_block_size - 1)/reduction_block_size;
+   std::vector<T> partial(no_blocks);
+   parallel_for(e, no_blocks, [&](const std::size_t b) {
+      const std::size_t end = std::min(n, (b+1)*reduction_block_size);
+      T s = 0;
+      for(std::size_t i=b*reduction_block_size; i<end; ++i) {
+         s += value(i);
+      }
+      partial[b] = s;
+   });
+   return pairwise_sum(partial, 0, no_blocks);
+}
+
+template<typename T, typename FUNC>
+T deterministic_sum(const std::size_t n, FUNC value)
+{
+   return deterministic_sum<T>(default_executor(), n, value);
+}
+
+// whether pred(i) holds for all i=0,...,n-1. Blocks not yet started are skipped once a violation is found.
+template<typename FUNC>
+bool parallel_all_of(executor& e, const std::size_t n, FUNC pred)
+{
+   const std::size_t no_blocks = (n + reduction_block_size - 1)/reduction_block_size;
+   std::atomic<bool> all(true);
+   e.run(no_blocks, [&](const std::size_t b) {
+      if(!all.load(std::memory_order_relaxed)) { return; }
+      const std::size_t end = std::min(n, (b+1)*reduction_block_size);
+      for(std::size_t i=b*reduction_block_size; i<end; ++i) {
+         if(!pred(i)) {
+            all.store(false, std::memory_order_relaxed);
+            return;
+         }
+      }
+   });
+   return all;
+}
+
+template<typename FUNC>
+bool parallel_all_of(const std::size_t n, FUNC pred)
+{
+   return parallel_all_of(default_executor(), n, pred);
+}
+
+} // end namespace LP_MP
+
+#endif // LP_MP_REDUCTION_HXX
@@ -9,6 +9,8 @@
 #include <sstream>
 
 #include "LP_MP.h"
+#include "checkpoint.hxx"
+#include "async_rounding.hxx"
 #include "function_existence.hxx"
 #include "template_utilities.hxx"
 #include "tclap/CmdLine.h"
@@ -57,6 +59,11 @@ private:
         lp_(cmd_),
         inputFileArg_("i","inputFile","file from which to read problem instance",false,"","file name",cmd_),
         outputFileArg_("o","outputFile","file to write solution",false,"","file name",cmd_),
+        saveModelArg_("","saveModel","write constructed problem into binary model file before optimization",false,"","file name",cmd_),
+        loadModelArg_("","loadModel","read problem from binary model file written by --saveModel instead of parsing the input file. Solutions cannot be written, since problem constructors are not rebuilt",false,"","file name",cmd_),
+        checkpointFileArg_("","checkpoint","file into which the dual state is written periodically in the background",false,"","file name",cmd_),
+        checkpointIntervalArg_("","checkpointInterval","number of iterations between checkpoints, default = 100",false,100,&positiveIntegerConstraint,cmd_),
+        resumeArg_("","resume","resume optimization from the dual state in the checkpoint file, if it exists. Iterations are counted from the checkpoint on, the best primal solution is not restored",cmd_,false),
         verbosity_arg_("v","verbosity","verbosity level: 0 = silent, 1 = important runtime information, 2 = further diagnostics",false,1,"0,1,2",cmd_),
         visitor_(cmd_)
    {
@@ -99,6 +106,11 @@ public:
    template<class INPUT_FUNCTION, typename... ARGS>
    bool ReadProblem(INPUT_FUNCTION inputFct, ARGS... args)
    {
+      if(loadModelArg_.isSet()) {
+         if(outputFileArg_.isSet()) { throw std::runtime_error("--loadModel cannot be combined with --outputFile"); }
+         lp_.load_model(loadModelArg_.getValue());
+         return true;
+      }
       const bool success = inputFct(inputFile_, *this, args...);
 
       assert(success);
@@ -226,6 +238,13 @@ public:
    {
       return has_solution<VISITOR, void, std::string>();
    } 
+
+   LP_MP_FUNCTION_EXISTENCE_CLASS(has_resume,resume)
+   constexpr static bool
+   visitor_has_resume()
+   {
+      return has_resume<VISITOR, void, INDEX>();
+   } 
    
    int Solve()
    {
@@ -233,14 +252,59 @@ public:
          std::cout << "lower bound before optimization = " << lp_.LowerBound() << "\n";
       }
 
+      if(saveModelArg_.isSet()) {
+         lp_.save_model(saveModelArg_.getValue());
+      }
+
+      std::unique_ptr<dual_checkpoint> checkpoint;
+      INDEX resumed_iter = 0;
+      if(checkpointFileArg_.isSet()) {
+         checkpoint = std::make_unique<dual_checkpoint>(checkpointFileArg_.getValue());
+         if(resumeArg_.getValue() && checkpoint->exists()) {
+            iter = checkpoint->load(lp_);
+            resumed_iter = iter;
+            if(diagnostics()) { std::cout << "resumed from checkpoint " << checkpoint->filename() << " taken in iteration " << iter << "\n"; }
+         }
+      } else if(resumeArg_.getValue()) {
+         throw std::runtime_error("--resume requires --checkpoint");
+      }
+
       this->Begin();
+      return optimize(checkpoint.get(), resumed_iter);
+   }
+
+   // warm start: continue optimization after potentials were changed through GetLP().update_potentials, without reading the problem and calling Begin again.
+   // The reparametrization, factor orderings and weights are kept. The best primal solution is discarded, since its cost refers to the old potentials.
+   int Resolve()
+   {
+      bestPrimalCost_ = std::numeric_limits<REAL>::infinity();
+      solution_.clear();
+      return optimize(nullptr);
+   }
+
+protected:
+   // iterations until the visitor ends optimization, followed by primal registration and output.
+   // After resuming from a checkpoint taken in iteration resumed_iter, the visitor continues counting from there.
+   int optimize(dual_checkpoint* checkpoint, const INDEX resumed_iter = 0)
+   {
       LpControl c = visitor_.begin(this->lp_);
+      if(resumed_iter > 0) {
+         if constexpr(visitor_has_resume()) {
+            visitor_.resume(resumed_iter);
+         }
+      }
       while(!c.end && !c.error) {
          this->PreIterate(c);
          this->Iterate(c);
          this->PostIterate(c);
          c = visitor_.visit(c, this->lowerBound_, this->bestPrimalCost_);
          ++iter;
+         if(checkpoint && iter % checkpointIntervalArg_.getValue() == 0) {
+            checkpoint->save(lp_, iter);
+         }
+      }
+      if(checkpoint) {
+         checkpoint->wait();
       }
       if(!c.error) {
          this->End();
@@ -256,7 +320,7 @@ public:
       return !c.error;
    }
 
-
+public:
    // called before first iterations
    virtual void Begin() 
    {
@@ -307,11 +371,11 @@ public:
    }
 
    // register evaluated primal solution
+   // register primal solution held in the factors, whose cost was already evaluated
    void RegisterPrimal(const REAL cost)
    {
-      assert(false);
-      if(cost < bestPrimalCost_) {
-         // assume solution is feasible
+      if(debug()) { std::cout << "register primal cost = " << cost << "\n"; }
+      if(cost < bestPrimalCost_ && CheckPrimalConsistency()) {
          bestPrimalCost_ = cost;
          solution_ = write_primal_into_string();
       }
@@ -363,6 +427,11 @@ protected:
    // command line arguments
    TCLAP::ValueArg<std::string> inputFileArg_;
    TCLAP::ValueArg<std::string> outputFileArg_;
+   TCLAP::ValueArg<std::string> saveModelArg_;
+   TCLAP::ValueArg<std::string> loadModelArg_;
+   TCLAP::ValueArg<std::string> checkpointFileArg_;
+   TCLAP::ValueArg<INDEX> checkpointIntervalArg_;
+   TCLAP::SwitchArg resumeArg_;
    std::string inputFile_;
    std::string outputFile_;
 
@@ -399,6 +468,54 @@ public:
 private:
 };
 
+// local rounding as in MpRoundingSolver, but done on a copy of the LP in a background thread while message passing continues.
+// Primals found are registered in the iterations after they become available.
+template<typename SOLVER>
+class AsyncMpRoundingSolver : public SOLVER
+{
+public:
+  using SOLVER::SOLVER;
+  using LpType = typename std::remove_reference<decltype(std::declval<SOLVER>().GetLP())>::type;
+
+  virtual void Iterate(LpControl c)
+  {
+    if(c.computePrimal) {
+      if(!rounding_) {
+        rounding_ = std::make_unique<async_primal_rounding<LpType>>(this->lp_);
+      }
+      rounding_->submit(c.repam);
+    }
+    SOLVER::Iterate(c);
+  }
+
+  virtual void PostIterate(LpControl c)
+  {
+    register_rounded_primal();
+    SOLVER::PostIterate(c);
+  }
+
+  virtual void End()
+  {
+    if(rounding_) {
+      rounding_->wait();
+      register_rounded_primal();
+    }
+    SOLVER::End();
+  }
+
+private:
+  void register_rounded_primal()
+  {
+    if(!rounding_) { return; }
+    const REAL cost = rounding_->fetch();
+    if(cost < this->bestPrimalCost_) {
+      this->RegisterPrimal(cost);
+    }
+  }
+
+  std::unique_ptr<async_primal_rounding<LpType>> rounding_;
+};
+
 // rounding based on primal heuristics provided by problem constructor
 template<typename SOLVER>
 class ProblemConstructorRoundingSolver : public SOLVER
@@ -2,17 +2,27 @@
 #define LP_MP_SPINLOCK_HXX 
 
 #include <atomic>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <mutex>
 
 #if defined(_MSC_VER) && _MSC_VER >= 1310 && ( defined(_M_IX86) || defined(_M_X64) )
 
 extern "C" void _mm_pause();
 
-#define LP_MP_SMT_PAUSE _mm_pause();
+#define LP_MP_PAUSE _mm_pause();
 
 #elif defined(__GNUC__) && ( defined(__i386__) || defined(__x86_64__) )
 
 #define LP_MP_PAUSE __asm__ __volatile__( "rep; nop" : : : "memory" );
 
+#else
+
+#define LP_MP_PAUSE
+
 #endif
 
 
@@ -31,6 +41,95 @@ namespace LP_MP {
   }
 };
 
+// nonzero tags 1,...,max_tag for identifying threads. A tag is held by at most one thread at a time, it is handed out again only after release.
+class thread_tag_pool {
+public:
+  thread_tag_pool(const std::uint32_t max_tag) : max_tag_(max_tag) {}
+
+  std::uint32_t acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(!free_tags_.empty()) {
+      const std::uint32_t tag = free_tags_.back();
+      free_tags_.pop_back();
+      return tag;
+    }
+    if(next_tag_ > max_tag_) {
+      throw std::runtime_error("thread_tag_pool: more than " + std::to_string(max_tag_) + " threads alive");
+    }
+    return next_tag_++;
+  }
+  void release(const std::uint32_t tag) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    assert(tag > 0 && tag < next_tag_);
+    free_tags_.push_back(tag);
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<std::uint32_t> free_tags_;
+  std::uint32_t next_tag_ = 1;
+  const std::uint32_t max_tag_;
+};
+
+inline thread_tag_pool& spinlock_thread_tag_pool()
+{
+  static thread_tag_pool pool((1u << 20) - 1);
+  return pool;
+}
+
+// small nonzero number identifying the calling thread among all live threads. The tag is returned to the pool when the thread exits.
+inline std::uint32_t spinlock_thread_tag()
+{
+  struct thread_tag {
+    thread_tag() : tag(spinlock_thread_tag_pool().acquire()) {}
+    ~thread_tag() { spinlock_thread_tag_pool().release(tag); }
+    const std::uint32_t tag;
+  };
+  thread_local const thread_tag t;
+  return t.tag;
+}
+
+// reentrant spinlock in 4 bytes: the owning thread's tag is kept in the upper 20 bits, the recursion depth in the lower 12 bits.
+// At most 2^20-1 threads may be alive at once, spinlock_thread_tag throws for further ones.
+class recursive_spinlock {
+  std::atomic<std::uint32_t> state_{0};
+  constexpr static std::uint32_t depth_bits = 12;
+  constexpr static std::uint32_t depth_mask = (1u << depth_bits) - 1;
+  public:
+  bool try_lock() {
+    const std::uint32_t owner = spinlock_thread_tag() << depth_bits;
+    std::uint32_t s = state_.load(std::memory_order_relaxed);
+    if(s == 0) {
+      return state_.compare_exchange_strong(s, owner | 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+    if((s & ~depth_mask) == owner) { // only the owner can get here, no other thread writes state_ now
+      if((s & depth_mask) == depth_mask) {
+        throw std::runtime_error("recursive_spinlock: recursion depth exceeds " + std::to_string(depth_mask));
+      }
+      state_.store(s + 1, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+  void lock() {
+    while(!try_lock()) {
+      while(state_.load(std::memory_order_relaxed) != 0) {
+        LP_MP_PAUSE
+      }
+    }
+  }
+  void unlock() {
+    const std::uint32_t s = state_.load(std::memory_order_relaxed);
+    assert((s & ~depth_mask) == spinlock_thread_tag() << depth_bits && (s & depth_mask) > 0);
+    if((s & depth_mask) == 1) {
+      state_.store(0, std::memory_order_release);
+    } else {
+      state_.store(s - 1, std::memory_order_relaxed);
+    }
+  }
+};
+static_assert(sizeof(recursive_spinlock) == 4, "");
+
 } // end namespace LP_MP
 
 #endif // LP_MP_SPINLOCK_HXX
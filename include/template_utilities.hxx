@@ -33,6 +33,21 @@ namespace LP_MP {
          for_each_tuple_impl(std::forward<Tuple>(tuple), std::forward<F>(f), std::make_index_sequence<N>{});
       }
 
+   // tuple iteration from the last to the first element
+   template <std::size_t N, typename Tuple, typename F>
+      void for_each_tuple_reverse_impl(Tuple&& tuple, F&& f) {
+         if constexpr(N > 0) {
+            f(std::get<N-1>(tuple));
+            for_each_tuple_reverse_impl<N-1>(tuple, f);
+         }
+      }
+
+   template <typename Tuple, typename F>
+      void for_each_tuple_reverse(Tuple&& tuple, F&& f) {
+         constexpr std::size_t N = std::tuple_size<std::remove_reference_t<Tuple>>::value;
+         for_each_tuple_reverse_impl<N>(std::forward<Tuple>(tuple), std::forward<F>(f));
+      }
+
    // iterate over two tuples in order
    template <typename Tuple, typename F, std::size_t ...Indices>
       void for_each_tuple_pair_impl(Tuple&& tuple_1, Tuple&& tuple_2, F&& f, std::index_sequence<Indices...>) {
@@ -595,17 +595,26 @@ public:
    template<typename VECTOR1>
    void compute_mapped_subgradient(VECTOR1& subgradient)
    {
-      //const REAL subgradient_value = compute_subgradient();
-      //assert(false); // assert that subgradient has been computed!
-      std::vector<double> local_subgradient(mapping_.size(),0.0);
-      // write primal solution into subgradient
+      compute_local_subgradient();
+      add_mapped_subgradient(subgradient);
+   }
+
+   // write primal solution into the tree's own subgradient buffer. Touches no state of other trees.
+   void compute_local_subgradient()
+   {
+      local_subgradient_.assign(mapping_.size(), 0.0);
       for(auto L : Lagrangean_factors_) {
-         L.copy_fn(&local_subgradient[0]);
+         L.copy_fn(&local_subgradient_[0]);
       }
-      assert(mapping_.size() >= dual_size());
+   }
+
+   template<typename VECTOR1>
+   void add_mapped_subgradient(VECTOR1& subgradient) const
+   {
+      assert(local_subgradient_.size() == mapping_.size());
       for(INDEX i=0; i<mapping_.size(); ++i) {
          assert(mapping_[i] < subgradient.size());
-         subgradient[ mapping_[i] ] += local_subgradient[i];
+         subgradient[ mapping_[i] ] += local_subgradient_[i];
       } 
    }
 
@@ -648,6 +657,41 @@ public:
       }
    }
 
+   // make the weights contained in the tree equal scaling*wi by adding the difference to the weights set in the last call.
+   // Lagrangean factors none of whose multipliers changed are not touched, so weights need not be removed after each oracle call.
+   // Do not mix with add_weights.
+   void set_weights(const double* wi, const double scaling)
+   {
+      const INDEX n = mapping_.size();
+      if(applied_weights_.size() != n) { applied_weights_.assign(n, 0.0); }
+      weight_delta_.resize(n);
+      // the multipliers of each Lagrangean factor are contiguous and come in the order of Lagrangean_factors_, see add_to_mapping
+      for(INDEX k=0; k<Lagrangean_factors_.size(); ++k) {
+         auto& L = Lagrangean_factors_[k];
+         const INDEX begin = L.local_Lagrangean_vars_offset_;
+         const INDEX end = k+1 < Lagrangean_factors_.size() ? Lagrangean_factors_[k+1].local_Lagrangean_vars_offset_ : n;
+         bool changed = false;
+         for(INDEX i=begin; i<end; ++i) {
+            const double w = scaling*wi[i];
+            weight_delta_[i] = w - applied_weights_[i];
+            changed |= (weight_delta_[i] != 0.0);
+            applied_weights_[i] = w;
+         }
+         if(changed) {
+            L.serialize_Lagrangean(&weight_delta_[0], 1.0);
+         }
+      }
+   }
+
+   // take out weights added by set_weights
+   void remove_weights()
+   {
+      if(applied_weights_.size() > 0) {
+         add_weights(&applied_weights_[0], -1.0);
+         applied_weights_.clear();
+      }
+   }
+
   // dual size of Lagrangeans connected to current tree
   INDEX compute_dual_size_in_bytes()
   {
@@ -707,6 +751,15 @@ public:
    std::vector<int> mapping_;
 
    std::vector<FactorTypeAdapter*> original_factors_;
+
+   // scratch space, one per tree so that trees can be processed concurrently
+   std::vector<double> local_weights_;
+   std::vector<double> local_subgradient_;
+
+   // weights currently contained in the tree's factors when using set_weights
+   std::vector<double> applied_weights_;
+   std::vector<double> weight_delta_;
+   bool sparse_weights_ = false;
 };
 
 // do zrobienia: templatize base class
@@ -716,7 +769,8 @@ class LP_with_trees : public LP<FMC>
 public:
    LP_with_trees(TCLAP::CmdLine& cmd)
      : LP<FMC>(cmd),
-     tree_decomposition_begin_arg_("","treeDecompositionBegin","after how many iterations to start tree decomposition based optimization", false, 0, "", cmd)
+     tree_decomposition_begin_arg_("","treeDecompositionBegin","after how many iterations to start tree decomposition based optimization", false, 0, "", cmd),
+     sparse_Lagrangean_weights_arg_("","sparseLagrangeanWeights","push only changed Lagrangean multipliers into trees instead of adding and removing all of them for each oracle call", cmd, false)
   {}
 
    ~LP_with_trees()
@@ -876,6 +930,7 @@ public:
          assert(m.size() <= Lagrangean_vars_size_);
          //assert(m.size() == t.dual_size());
          t.mapping_ = m;
+         t.sparse_weights_ = sparse_Lagrangean_weights_arg_.getValue();
       }
 
       // check map validity: each entry in m (except last one) must occur exactly twice
@@ -938,11 +993,14 @@ public:
      }
    }
 
-   REAL decomposition_lower_bound() const
+   REAL decomposition_lower_bound()
    {
+     // summed up sequentially, so that the result does not depend on the number of threads
+     std::vector<REAL> tree_lb(trees_.size());
+     for_each_tree([&](const INDEX i, auto& t) { tree_lb[i] = t.lower_bound(); });
      REAL lb = 0.0;
-     for(auto& t : trees_) {
-       lb += t.lower_bound();
+     for(const REAL x : tree_lb) {
+       lb += x;
      }
      return lb; 
    }
@@ -954,21 +1012,38 @@ public:
 
    void add_weights(const double* w, const REAL scaling) 
    {
-      for(INDEX i=0; i<trees_.size(); ++i) {
-         auto& tree = trees_[i];
-         const auto& m = tree.mapping();
-         std::vector<double> local_weights;
-         local_weights.reserve(m.size());
-         for(INDEX idx=0; idx<m.size(); ++idx) {
-            local_weights.push_back(w[m[idx]]);
-         }
-         tree.add_weights(&local_weights[0], scaling);
-      }
+      for_each_tree([&](const INDEX i, auto& tree) {
+         tree.add_weights(gather_weights(tree, w), scaling);
+      });
+   }
+
+   // see LP_tree_Lagrangean::set_weights
+   void set_weights(const double* w, const REAL scaling) 
+   {
+      for_each_tree([&](const INDEX i, auto& tree) {
+         tree.set_weights(gather_weights(tree, w), scaling);
+      });
+   }
+
+   void remove_weights()
+   {
+      for_each_tree([&](const INDEX i, auto& tree) { tree.remove_weights(); });
+   }
+
+   bool sparse_Lagrangean_weights() const { return sparse_Lagrangean_weights_arg_.getValue(); }
+
+   // call f(i, trees_[i]) for all trees. After construct_decomposition, factors occurring in several trees are cloned, hence trees share no factors and are processed concurrently.
+   // One task per tree, so that executors balance trees of different size.
+   template<typename FUNC>
+   void for_each_tree(FUNC f)
+   {
+      this->get_executor().run(trees_.size(), [&](const INDEX i) { f(i, trees_[i]); });
    }
 
   // write back reparametrization of tree decomposition factor into original factors
   void write_back_reparametrization()
   {
+      remove_weights();
       redirect_messages_to_original();
 
       // first set original factors to zero
@@ -988,9 +1063,21 @@ public:
   } 
 
 protected:
+   // copy global weights of the tree's multipliers into its scratch space
+   static const double* gather_weights(LP_tree_Lagrangean<FMC,LAGRANGEAN_FACTOR>& tree, const double* w)
+   {
+      const auto& m = tree.mapping();
+      tree.local_weights_.resize(m.size());
+      for(INDEX idx=0; idx<m.size(); ++idx) {
+         tree.local_weights_[idx] = w[m[idx]];
+      }
+      return &tree.local_weights_[0];
+   }
+
    std::vector<LP_tree_Lagrangean<FMC,LAGRANGEAN_FACTOR>> trees_; // store for each tree the associated Lagrangean factors.
    INDEX Lagrangean_vars_size_;
    TCLAP::ValueArg<INDEX> tree_decomposition_begin_arg_; 
+   TCLAP::SwitchArg sparse_Lagrangean_weights_arg_;
    bool constructed_decomposition = false;
 };
 
@@ -1005,12 +1092,18 @@ public:
 
    void optimize_decomposition(const INDEX iteration)
    {
+      std::vector<REAL> tree_lb(this->trees_.size());
+      this->for_each_tree([&](const INDEX i, auto& t) {
+         tree_lb[i] = t.solve();
+         t.compute_local_subgradient();
+      });
+
+      // accumulation into the shared subgradient is done sequentially
       REAL current_lower_bound = 0.0;
       std::vector<REAL> subgradient(this->no_Lagrangean_vars(), 0.0);
       for(std::size_t i=0; i<this->trees_.size(); ++i) {
-         current_lower_bound += this->trees_[i].solve();
-         this->trees_[i].compute_mapped_subgradient(subgradient); // note that mapping has one extra component!
-         //trees_[i].primal_cost();
+         current_lower_bound += tree_lb[i];
+         this->trees_[i].add_mapped_subgradient(subgradient); // note that mapping has one extra component!
       }
 
       best_lower_bound = std::max(current_lower_bound, best_lower_bound);
@@ -88,7 +88,7 @@ public:
     assert(size > 0);
     const INDEX padding = std::is_same<REAL,T>::value ? (REAL_ALIGNMENT-(size%REAL_ALIGNMENT))%REAL_ALIGNMENT : 0;
     //begin_ = (T*) global_real_block_allocator_array[stack_allocator_index].allocate(size+padding,32);
-    begin_ = (T*) global_real_block_arena_array[stack_allocator_index].allocate((size+padding)*sizeof(T),32);
+    begin_ = (T*) local_real_block_arena().allocate((size+padding)*sizeof(T),32);
     assert(begin_ != nullptr);
     end_ = begin_ + size;
     for(auto it=this->begin(); begin!=end; ++begin, ++it) {
@@ -107,7 +107,7 @@ public:
     }
     //begin_ = global_real_block_allocator_array[stack_allocator_index].allocate(size+padding,32);
     //begin_ = (T*) global_real_block_allocator_array[stack_allocator_index].allocate(size+padding,32);
-    begin_ = (T*) global_real_block_arena_array[stack_allocator_index].allocate((size+padding)*sizeof(T),32);
+    begin_ = (T*) local_real_block_arena().allocate((size+padding)*sizeof(T),32);
     assert(size > 0);
     assert(begin_ != nullptr);
     end_ = begin_ + size;
@@ -127,7 +127,7 @@ public:
   ~vector() {
      if(begin_ != nullptr) {
         //global_real_block_allocator_array[stack_allocator_index].deallocate((void*)begin_,1);
-        global_real_block_arena_array[stack_allocator_index].deallocate((void*)begin_);
+        owning_real_block_arena(begin_).deallocate((void*)begin_);
      }
      static_assert(sizeof(T) % sizeof(int) == 0,"");
   }
@@ -351,7 +351,6 @@ public:
 
        if constexpr(std::is_same<T,float>::value) {
 
-           assert(false); // does not work yet
            simdpp::float32<8> min_val = simdpp::make_float(std::numeric_limits<REAL>::infinity());
            simdpp::float32<8> second_min_val = simdpp::make_float(std::numeric_limits<REAL>::infinity());
            for(auto it=begin_; it<end_; it+=8) {
@@ -363,19 +362,12 @@ public:
            }
 
            // second minimum is the minimum of the second minimum in vector min and the minimum in second_min_val
-           simdpp::float32<4> x1;
-           simdpp::float32<4> y1;
-           simdpp::split(min_val, x1, y1);
-           simdpp::float32<4> min2 = simdpp::min(x1, y1);
-           simdpp::float32<4> max2 = simdpp::max(x1, y1);
-
-           std::array<T,4> min_array; //
-           min_array[0] = min2.vec(0); //min2.vec(1), min2.vec(2), min2.vec(3)});
-           const auto min3 = two_smallest_elements<T>(min_array.begin(), min_array.end());
-           //const REAL min = simdpp::reduce_min(min2);
-           const REAL second_min = std::min({simdpp::reduce_min(second_min_val), simdpp::reduce_min(max2), min3[1]});
-           assert(second_min >= min3[0]);
-           return std::array<T,2>({min3[0], second_min});
+           alignas(32) std::array<T,8> min_lanes;
+           simdpp::store(min_lanes.data(), min_val);
+           const auto min2 = two_smallest_elements<T>(min_lanes.begin(), min_lanes.end());
+           const T second_min = std::min(min2[1], simdpp::reduce_min(second_min_val));
+           assert(second_min >= min2[0]);
+           return std::array<T,2>({min2[0], second_min});
 
    } else if constexpr(std::is_same<T,double>::value) {
 
@@ -3,6 +3,7 @@
 
 #include "LP_MP.h"
 #include "config.hxx"
+#include "profiling.hxx"
 #include "mem_use.c"
 #include "tclap/CmdLine.h"
 #include <chrono>
@@ -96,6 +97,8 @@ namespace LP_MP {
 
          //spdlog::get("logger")->info() << "Initial number of factors = " << lp->GetNumberOfFactors();
          beginTime_ = std::chrono::steady_clock::now();
+         update_statistics_ = &lp.update_statistics();
+         last_update_statistics_ = *update_statistics_;
 
 
          LpControl ret;
@@ -124,12 +127,23 @@ namespace LP_MP {
               if(c.computePrimal) {
                 std::cout << ", upper bound = " << primalBound;
               }
+              if(update_statistics_ != nullptr && update_statistics_->skipped > last_update_statistics_.skipped) {
+                const std::size_t updated = update_statistics_->updated - last_update_statistics_.updated;
+                const std::size_t skipped = update_statistics_->skipped - last_update_statistics_.skipped;
+                std::cout << ", skipped factor updates = " << skipped << "/" << (updated + skipped);
+              }
+              if(update_statistics_ != nullptr && update_statistics_->lower_bounds_cached > last_update_statistics_.lower_bounds_cached) {
+                const std::size_t recomputed = update_statistics_->lower_bounds_recomputed - last_update_statistics_.lower_bounds_recomputed;
+                const std::size_t cached = update_statistics_->lower_bounds_cached - last_update_statistics_.lower_bounds_cached;
+                std::cout << ", recomputed factor lower bounds = " << recomputed << "/" << (recomputed + cached);
+              }
               std::cout << ", time elapsed = " << timeElapsed/1000 << "." << (timeElapsed%1000)/10 << "s\n";
             }
          }
 
          curIter_++;
          remainingIter_--;
+         if(update_statistics_ != nullptr) { last_update_statistics_ = *update_statistics_; }
 
          LpControl ret;
 
@@ -195,13 +209,23 @@ namespace LP_MP {
          if(verbosity >= 1) { 
            std::cout << "final lower bound = " << lower_bound << ", upper bound = " << upper_bound << "\n";
            std::cout << "Optimization took " <<  std::chrono::duration_cast<std::chrono::milliseconds>(endTime - beginTime_).count() << " milliseconds and " << curIter_ << " iterations.\n";
+           LP_MP_PRINT_PROFILE(std::cout)
          }
       }
       
+      // called after begin when optimization is resumed from a checkpoint taken in iteration iter: counting continues from there and the iterations already done are taken from --maxIter
+      void resume(const INDEX iter)
+      {
+         curIter_ = iter;
+         remainingIter_ = iter < maxIter_ ? maxIter_ - iter : 1;
+      }
+
       using TimeType = decltype(std::chrono::steady_clock::now());
       TimeType GetBeginTime() const { return beginTime_; }
       //`REAL GetLowerBound() const { return curLowerBound_; }
       INDEX GetIter() const { return curIter_; }
+      // cumulative number of updated and skipped factors, see --skipConvergedFactors
+      factor_update_statistics GetUpdateStatistics() const { return update_statistics_ != nullptr ? *update_statistics_ : factor_update_statistics(); }
 
       protected:
       PositiveRealConstraint posRealConstraint_;
@@ -240,6 +264,8 @@ namespace LP_MP {
       REAL prevLowerBound_ = -std::numeric_limits<REAL>::max();
       REAL curLowerBound_ = -std::numeric_limits<REAL>::max();
       TimeType beginTime_;
+      const factor_update_statistics* update_statistics_ = nullptr; // owned by the LP
+      factor_update_statistics last_update_statistics_; // at the previous visit
 
       // primal
       //REAL bestPrimalCost_ = std::numeric_limits<REAL>::infinity();
@@ -0,0 +1,145 @@
+#ifndef LP_MP_WORK_STEALING_SCHEDULE_HXX
+#define LP_MP_WORK_STEALING_SCHEDULE_HXX
+
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cassert>
+#include "spinlock.hxx"
+
+namespace LP_MP {
+
+// distributes the index range [0,n) in chunks of consecutive indices over per-thread queues.
+// Each thread processes its own queue front to back, idle threads steal chunks from the back of other queues.
+// Initially thread t owns the t-th contiguous block of chunks, hence without stealing the assignment is the usual static one.
+class work_stealing_schedule {
+public:
+   struct thread_statistics {
+      double busy_time = 0.0; // seconds spent in work function
+      double idle_time = 0.0; // seconds spent stealing or waiting for other threads to finish the pass
+      std::size_t chunks_processed = 0;
+      std::size_t chunks_stolen = 0;
+   };
+
+   // must be called outside of parallel region before each pass
+   void init(const std::size_t n, const std::size_t no_threads, const std::size_t chunk_size)
+   {
+      assert(no_threads > 0 && chunk_size > 0);
+      n_ = n;
+      chunk_size_ = chunk_size;
+      if(queues_.size() != no_threads) {
+         std::vector<chunk_queue> queues(no_threads);
+         queues_.swap(queues);
+         statistics_.resize(no_threads);
+         pass_busy_time_.resize(no_threads);
+      }
+      const std::size_t no_chunks = (n + chunk_size - 1)/chunk_size;
+      for(std::size_t t=0; t<no_threads; ++t) {
+         queues_[t].front = (t*no_chunks)/no_threads;
+         queues_[t].back = ((t+1)*no_chunks)/no_threads;
+      }
+      std::fill(pass_busy_time_.begin(), pass_busy_time_.end(), 0.0);
+      pass_begin_ = std::chrono::steady_clock::now();
+   }
+
+   // must be called by each thread inside the parallel region. f(begin, end) processes indices [begin,end).
+   template<typename FUNC>
+   void run(const std::size_t thread_no, FUNC f, const bool steal = true)
+   {
+      assert(thread_no < queues_.size());
+      // counters are accumulated locally and stored once at the end, since entries of neighbouring threads share cache lines
+      double busy_time = 0.0;
+      std::size_t chunks_processed = 0;
+      std::size_t chunks_stolen = 0;
+      std::size_t chunk;
+      while(pop_front(thread_no, chunk)) {
+         busy_time += process_chunk(chunk, f);
+         ++chunks_processed;
+      }
+
+      // own queue is empty, try to steal from the others. No new work is created during a pass, hence one unsuccessful round over all queues means we are done.
+      bool stolen = steal;
+      while(stolen) {
+         stolen = false;
+         for(std::size_t k=1; k<queues_.size(); ++k) {
+            const std::size_t victim = (thread_no + k) % queues_.size();
+            if(pop_back(victim, chunk)) {
+               busy_time += process_chunk(chunk, f);
+               ++chunks_processed;
+               ++chunks_stolen;
+               stolen = true;
+               break;
+            }
+         }
+      }
+
+      pass_busy_time_[thread_no] += busy_time;
+      statistics_[thread_no].chunks_processed += chunks_processed;
+      statistics_[thread_no].chunks_stolen += chunks_stolen;
+   }
+
+   // for threads that process a statically assigned range without the queues
+   void add_busy_time(const std::size_t thread_no, const double seconds) { pass_busy_time_[thread_no] += seconds; }
+
+   // must be called outside of parallel region after each pass. Attributes the time not spent working to idle time.
+   void finish()
+   {
+      const double pass_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - pass_begin_).count();
+      for(std::size_t t=0; t<statistics_.size(); ++t) {
+         statistics_[t].busy_time += pass_busy_time_[t];
+         statistics_[t].idle_time += std::max(0.0, pass_time - pass_busy_time_[t]);
+      }
+   }
+
+   const std::vector<thread_statistics>& statistics() const { return statistics_; }
+   void reset_statistics() { std::fill(statistics_.begin(), statistics_.end(), thread_statistics{}); }
+
+private:
+   struct alignas(64) chunk_queue {
+      spinlock lock;
+      std::size_t front = 0;
+      std::size_t back = 0;
+   };
+
+   bool pop_front(const std::size_t t, std::size_t& chunk)
+   {
+      auto& q = queues_[t];
+      q.lock.lock();
+      const bool nonempty = q.front < q.back;
+      if(nonempty) { chunk = q.front++; }
+      q.lock.unlock();
+      return nonempty;
+   }
+
+   bool pop_back(const std::size_t t, std::size_t& chunk)
+   {
+      auto& q = queues_[t];
+      q.lock.lock();
+      const bool nonempty = q.front < q.back;
+      if(nonempty) { chunk = --q.back; }
+      q.lock.unlock();
+      return nonempty;
+   }
+
+   // returns seconds spent in f
+   template<typename FUNC>
+   double process_chunk(const std::size_t chunk, FUNC& f)
+   {
+      const std::size_t begin = chunk*chunk_size_;
+      const std::size_t end = std::min(n_, begin + chunk_size_);
+      const auto t0 = std::chrono::steady_clock::now();
+      f(begin, end);
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+   }
+
+   std::size_t n_ = 0;
+   std::size_t chunk_size_ = 1;
+   std::vector<chunk_queue> queues_;
+   std::vector<thread_statistics> statistics_; // entry t is written by thread t once per run() during a pass, read in finish()
+   std::vector<double> pass_busy_time_; // entry t is written by thread t once per run() or add_busy_time() call
+   std::chrono::steady_clock::time_point pass_begin_;
+};
+
+} // end namespace LP_MP
+
+#endif // LP_MP_WORK_STEALING_SCHEDULE_HXX
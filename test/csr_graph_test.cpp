@@ -0,0 +1,97 @@
+#include "test.h"
+#include "csr_graph.hxx"
+#include <random>
+
+using namespace LP_MP;
+
+int main(int argc, char** argv)
+{
+	std::mt19937 gen(3);
+	std::uniform_int_distribution<std::size_t> node(0,299);
+	std::vector<std::array<std::size_t,2>> edges;
+	for(std::size_t c=0; c<3000; ++c) {
+		// every eighth edge is incident to node 0, so that it is a node of high degree
+		const std::size_t i = c%8 == 0 ? 0 : node(gen);
+		const std::size_t j = node(gen);
+		if(i != j) { edges.push_back({std::min(i,j), std::max(i,j)}); }
+	}
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+	// orientation and order of input edges do not matter
+	std::vector<std::array<std::size_t,2>> shuffled_edges(edges);
+	std::shuffle(shuffled_edges.begin(), shuffled_edges.end(), gen);
+	for(std::size_t e=0; e<shuffled_edges.size(); e+=2) { std::swap(shuffled_edges[e][0], shuffled_edges[e][1]); }
+
+	auto edge_value = [](const auto& e) { return double(std::min(e[0],e[1])*1000 + std::max(e[0],e[1])); };
+	graph<double> g(edges.begin(), edges.end(), edge_value);
+	csr_graph<double> c(shuffled_edges.begin(), shuffled_edges.end(), edge_value);
+	csr_graph<double> c_from_graph(g);
+
+	for(const auto* h : {&c, &c_from_graph}) {
+		test(h->no_nodes() == g.no_nodes());
+		test(h->no_edges() == edges.size());
+		for(std::size_t i=0; i<g.no_nodes(); ++i) {
+			test(h->no_edges(i) == g.no_edges(i));
+			auto g_it = g.begin(i);
+			for(auto it=h->begin(i); it!=h->end(i); ++it, ++g_it) {
+				test(it->tail() == i);
+				test(it->head() == g_it->head());
+				test(it->edge() == g_it->edge());
+				test(it->sister().tail() == it->head() && it->sister().head() == i && it->sister().id() == it->id());
+				test(h->edge_present(i, it->head()));
+				test(h->edge(i, it->head()) == edge_value(std::array<std::size_t,2>{i, it->head()}));
+			}
+		}
+
+		// edge ids enumerate edges lexicographically
+		std::size_t id = 0;
+		h->for_each_edge([&](const std::size_t i, const std::size_t j, const double e) {
+			test(i < j);
+			test(edges[id] == std::array<std::size_t,2>({i,j}));
+			test(h->edge_id(i,j) == id && h->edge_id(j,i) == id);
+			test(e == edge_value(edges[id]));
+			++id;
+		});
+		test(id == edges.size());
+	}
+	for(std::size_t i=0; i<c.no_nodes(); ++i) {
+		for(std::size_t j=i+1; j<c.no_nodes(); ++j) {
+			test(c.edge_present(i,j) == std::binary_search(edges.begin(), edges.end(), std::array<std::size_t,2>({i,j})));
+		}
+	}
+
+	std::vector<std::array<std::size_t,3>> triangles;
+	g.for_each_triangle([&](const std::size_t i, const std::size_t j, const std::size_t k, const auto&, const auto&, const auto&) { triangles.push_back({i,j,k}); });
+	std::sort(triangles.begin(), triangles.end());
+	test(triangles.size() > 0);
+	for(const auto kernel : {triangle_intersection_kernel::adaptive, triangle_intersection_kernel::merge, triangle_intersection_kernel::galloping, triangle_intersection_kernel::bitset}) {
+		std::vector<std::array<std::size_t,3>> csr_triangles;
+		c.for_each_triangle([&](const std::size_t i, const std::size_t j, const std::size_t k, const auto& ij, const auto& ik, const auto& jk) {
+			test(ij.tail() == i && ij.head() == j && ik.tail() == i && ik.head() == k && jk.tail() == j && jk.head() == k);
+			test(ij.edge() == edge_value(std::array<std::size_t,2>{i,j}) && jk.edge() == edge_value(std::array<std::size_t,2>{j,k}));
+			csr_triangles.push_back({i,j,k});
+		}, kernel);
+		std::sort(csr_triangles.begin(), csr_triangles.end());
+		test(triangles == csr_triangles);
+	}
+
+	// shortest paths are found on both representations
+	bfs_data<graph<double>> g_bfs(g);
+	bfs_data<csr_graph<double>> c_bfs(c);
+	for(std::size_t i=1; i<20; ++i) {
+		const auto g_path = g_bfs.find_path(i, 2*i);
+		const auto c_path = c_bfs.find_path(i, 2*i);
+		test(g_path.size() == c_path.size());
+		test(std::min(c_path.front(), c_path.back()) == i && std::max(c_path.front(), c_path.back()) == 2*i);
+		for(std::size_t p=0; p+1<c_path.size(); ++p) { test(c.edge_present(c_path[p], c_path[p+1])); }
+	}
+	std::vector<std::array<std::size_t,2>> queries;
+	for(std::size_t i=1; i<20; ++i) { queries.push_back({i%3, 5*i}); }
+	auto no_mask = [](const std::size_t, const std::size_t, const double) { return true; };
+	const auto g_paths = bfs_separation<graph<double>>(g).find_paths(queries, no_mask);
+	const auto c_paths = bfs_separation<csr_graph<double>>(c).find_paths(queries, no_mask);
+	for(std::size_t q=0; q<queries.size(); ++q) { test(g_paths[q].size() == c_paths[q].size()); }
+
+	// compact representation takes less than half the memory of graph: heads, sister pointers and edge information per direction there
+	test(2*c.memory_size() < 2*edges.size()*sizeof(graph<double>::edge_type));
+}
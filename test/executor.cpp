@@ -0,0 +1,100 @@
+#include "test.h"
+#include "executor.hxx"
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <stdexcept>
+
+using namespace LP_MP;
+
+// every task is run exactly once, parallel_for covers every index once and exceptions reach the caller
+void test_executor(executor& e)
+{
+   for(const INDEX no_tasks : {0, 1, 3, 100}) {
+      std::vector<std::atomic<INDEX>> calls(no_tasks);
+      for(auto& c : calls) { c = 0; }
+      e.run(no_tasks, [&](const INDEX t) { ++calls[t]; });
+      for(auto& c : calls) { test(c == 1); }
+   }
+
+   const INDEX n = 10007;
+   std::vector<std::atomic<INDEX>> visited(n);
+   for(auto& v : visited) { v = 0; }
+   parallel_for(e, n, [&](const INDEX i) { ++visited[i]; });
+   for(auto& v : visited) { test(v == 1); }
+
+   std::atomic<INDEX> finished(0);
+   bool thrown = false;
+   try {
+      e.run(20, [&](const INDEX t) {
+         if(t == 7) { throw std::runtime_error("task failed"); }
+         ++finished;
+      });
+   } catch(const std::runtime_error&) {
+      thrown = true;
+   }
+   test(thrown);
+   test(finished == 19);
+}
+
+int main(int argc, char** argv)
+{
+   {
+      sequential_executor e;
+      test_executor(e);
+   }
+
+#ifdef LP_MP_PARALLEL
+   {
+      openmp_executor e(4);
+      test_executor(e);
+
+      // nested calls get a team of fewer threads than requested, all tasks must run nevertheless
+      omp_set_max_active_levels(1);
+      std::atomic<INDEX> calls(0);
+      e.run(4, [&](const INDEX) { e.run(4, [&](const INDEX) { ++calls; }); });
+      test(calls == 16);
+      std::atomic<INDEX> visited(0);
+      e.run(2, [&](const INDEX) { parallel_for(e, 10000, [&](const INDEX) { ++visited; }); });
+      test(visited == 20000);
+   }
+#endif
+
+   {
+      thread_pool_executor e(4);
+      test_executor(e);
+   }
+
+   // several users of one pool at the same time
+   {
+      thread_pool_executor pool(3);
+      std::atomic<INDEX> sum(0);
+      std::vector<std::thread> users;
+      for(INDEX u=0; u<4; ++u) {
+         users.emplace_back([&]() { parallel_for(pool, 1000, [&](const INDEX i) { sum += i; }); });
+      }
+      for(auto& u : users) { u.join(); }
+      test(sum == 4*(999*1000/2));
+   }
+
+   // application supplied threads, including nested use from one of them
+   {
+      std::mutex threads_mutex;
+      std::vector<std::thread> application_threads;
+      {
+         callback_executor e(3, [&](std::function<void()> job) {
+            std::lock_guard<std::mutex> lock(threads_mutex);
+            application_threads.emplace_back(std::move(job));
+         });
+         test_executor(e);
+
+         std::atomic<INDEX> calls(0);
+         thread_pool_executor outer(2);
+         outer.run(2, [&](const INDEX) { e.run(8, [&](const INDEX) { ++calls; }); });
+         test(calls == 16);
+      }
+      // helper jobs may still be running after run returned, once all tasks are claimed
+      std::lock_guard<std::mutex> lock(threads_mutex);
+      for(auto& t : application_threads) { t.join(); }
+   }
+}
@@ -0,0 +1,67 @@
+#include "test.h"
+#include "graph_coloring.hxx"
+#include <random>
+#include <numeric>
+#include <array>
+#include <algorithm>
+
+using namespace LP_MP;
+
+two_dim_variable_array<std::size_t> adjacency_from_edges(const std::size_t n, const std::vector<std::array<std::size_t,2>>& edges)
+{
+   std::vector<std::size_t> degree(n, 0);
+   for(const auto& e : edges) { ++degree[e[0]]; ++degree[e[1]]; }
+   two_dim_variable_array<std::size_t> adjacency(degree);
+   std::fill(degree.begin(), degree.end(), 0);
+   for(const auto& e : edges) {
+      adjacency(e[0], degree[e[0]]++) = e[1];
+      adjacency(e[1], degree[e[1]]++) = e[0];
+   }
+   return adjacency;
+}
+
+int main(int argc, char** argv)
+{
+   // path 0-1-2-3-4: nodes of distance two must have distinct colors, hence three colors suffice
+   {
+      const auto adjacency = adjacency_from_edges(5, {{0,1},{1,2},{2,3},{3,4}});
+      std::vector<std::size_t> order(5);
+      std::iota(order.begin(), order.end(), 0);
+      const auto color = distance_two_coloring(adjacency, order.begin(), order.end());
+      test(color[0] == 0 && color[1] == 1 && color[2] == 2 && color[3] == 0 && color[4] == 1);
+   }
+
+   // only color even nodes of a path: uncolored nodes still separate them by distance two
+   {
+      const auto adjacency = adjacency_from_edges(5, {{0,1},{1,2},{2,3},{3,4}});
+      std::vector<std::size_t> order = {0,2,4};
+      const auto color = distance_two_coloring(adjacency, order.begin(), order.end());
+      test(color[0] == 0 && color[2] == 1 && color[4] == 0);
+      test(color[1] == std::numeric_limits<std::size_t>::max() && color[3] == std::numeric_limits<std::size_t>::max());
+   }
+
+   // random graphs: check distance two property
+   std::mt19937 gen(0);
+   for(std::size_t n=2; n<200; n+=7) {
+      std::uniform_int_distribution<std::size_t> dist(0,n-1);
+      std::vector<std::array<std::size_t,2>> edges;
+      for(std::size_t e=0; e<2*n; ++e) {
+         const std::size_t i = dist(gen);
+         const std::size_t j = dist(gen);
+         if(i != j) { edges.push_back({i,j}); }
+      }
+      const auto adjacency = adjacency_from_edges(n, edges);
+      std::vector<std::size_t> order(n);
+      std::iota(order.begin(), order.end(), 0);
+      std::shuffle(order.begin(), order.end(), gen);
+      const auto color = distance_two_coloring(adjacency, order.begin(), order.end());
+      for(std::size_t i=0; i<n; ++i) {
+         for(const std::size_t j : adjacency[i]) {
+            test(i == j || color[i] != color[j]);
+            for(const std::size_t k : adjacency[j]) {
+               test(i == k || color[i] != color[k]);
+            }
+         }
+      }
+   }
+}
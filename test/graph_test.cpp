@@ -1,6 +1,7 @@
 #include "test.h"
 #include "graph.hxx"
 #include <unordered_map>
+#include <random>
 
 using namespace LP_MP;
 
@@ -46,4 +47,155 @@ int main(int argc, char** argv)
 	decltype(edges) contraction_edges({{0,2}});
 	auto [contracted_graph, contraction_mapping] = g.contract(contraction_edges.begin(), contraction_edges.end());
 	test(contracted_graph.no_nodes() == 3);
+	// parallel enumeration on a random graph must agree with the sequential one
+	{
+		std::mt19937 gen(42);
+		std::uniform_int_distribution<std::size_t> node(0,199);
+		std::vector<std::array<std::size_t,2>> random_edges;
+		for(std::size_t c=0; c<2000; ++c) {
+			const std::size_t i = node(gen);
+			const std::size_t j = node(gen);
+			if(i != j) { random_edges.push_back({std::min(i,j), std::max(i,j)}); }
+		}
+		std::sort(random_edges.begin(), random_edges.end());
+		random_edges.erase(std::unique(random_edges.begin(), random_edges.end()), random_edges.end());
+		graph<empty> rg(random_edges.begin(), random_edges.end());
+
+		thread_pool_executor e(4);
+
+		std::vector<std::array<std::size_t,3>> seq_triangles;
+		rg.for_each_triangle([&](const std::size_t i, const std::size_t j, const std::size_t k, const auto&, const auto&, const auto&) { seq_triangles.push_back({i,j,k}); });
+		std::vector<std::vector<std::array<std::size_t,3>>> par_triangles(e.no_threads());
+		rg.for_each_triangle(e, [&](const std::size_t thread, const std::size_t i, const std::size_t j, const std::size_t k, const auto& ij, const auto& ik, const auto& jk) {
+			test(ij.head() == j && ik.head() == k && jk.head() == k);
+			par_triangles[thread].push_back({i,j,k});
+		});
+		std::vector<std::array<std::size_t,3>> all_par_triangles;
+		for(const auto& t : par_triangles) { all_par_triangles.insert(all_par_triangles.end(), t.begin(), t.end()); }
+		std::sort(seq_triangles.begin(), seq_triangles.end());
+		std::sort(all_par_triangles.begin(), all_par_triangles.end());
+		test(seq_triangles.size() > 0);
+		test(seq_triangles == all_par_triangles);
+
+		// both enumerations report a quadrangle with the same v and w, only u1 and u2 may be swapped
+		auto normalize = [](std::size_t v, std::size_t w, std::size_t u1, std::size_t u2) {
+			return std::array<std::size_t,4>({v,w,std::min(u1,u2),std::max(u1,u2)});
+		};
+		std::vector<std::array<std::size_t,4>> seq_quadrangles;
+		rg.for_each_quadrangle([&](const std::size_t v, const std::size_t w, const std::size_t u1, const std::size_t u2) { seq_quadrangles.push_back(normalize(v,w,u1,u2)); });
+		std::vector<std::vector<std::array<std::size_t,4>>> par_quadrangles(e.no_threads());
+		rg.for_each_quadrangle(e, [&](const std::size_t thread, const std::size_t v, const std::size_t w, const std::size_t u1, const std::size_t u2) {
+			test(rg.edge_present(v,u1) && rg.edge_present(u1,w) && rg.edge_present(w,u2) && rg.edge_present(u2,v));
+			par_quadrangles[thread].push_back(normalize(v,w,u1,u2));
+		});
+		std::vector<std::array<std::size_t,4>> all_par_quadrangles;
+		for(const auto& q : par_quadrangles) { all_par_quadrangles.insert(all_par_quadrangles.end(), q.begin(), q.end()); }
+		std::sort(seq_quadrangles.begin(), seq_quadrangles.end());
+		std::sort(all_par_quadrangles.begin(), all_par_quadrangles.end());
+		test(seq_quadrangles.size() > 0);
+		test(seq_quadrangles == all_par_quadrangles);
+
+		// top k triangles w.r.t. weight i*j*k are the largest ones in the sequential enumeration
+		const std::size_t k = 10;
+		auto best_triangles = rg.top_k_triangles(e, k, [](const std::size_t i, const std::size_t j, const std::size_t l, const auto&, const auto&, const auto&) { return double(i*j*l); });
+		std::sort(seq_triangles.begin(), seq_triangles.end(), [](const auto& t1, const auto& t2) {
+			const std::size_t w1 = t1[0]*t1[1]*t1[2];
+			const std::size_t w2 = t2[0]*t2[1]*t2[2];
+			return w1 > w2 || (w1 == w2 && t1 < t2);
+		});
+		test(best_triangles.size() == k);
+		for(std::size_t c=0; c<k; ++c) {
+			test(best_triangles[c].nodes == seq_triangles[c]);
+			test(best_triangles[c].weight == double(seq_triangles[c][0]*seq_triangles[c][1]*seq_triangles[c][2]));
+		}
+		sequential_executor seq_e;
+		auto seq_best_triangles = rg.top_k_triangles(seq_e, k, [](const std::size_t i, const std::size_t j, const std::size_t l, const auto&, const auto&, const auto&) { return double(i*j*l); });
+		for(std::size_t c=0; c<k; ++c) { test(best_triangles[c].nodes == seq_best_triangles[c].nodes); }
+
+		auto best_quadrangles = rg.top_k_quadrangles(e, k, [](const std::size_t v, const std::size_t w, const std::size_t u1, const std::size_t u2) { return double(v+w+u1+u2); });
+		test(best_quadrangles.size() == k);
+		for(std::size_t c=1; c<k; ++c) { test(best_quadrangles[c-1].weight >= best_quadrangles[c].weight); }
+		std::size_t max_weight = 0;
+		for(const auto& q : seq_quadrangles) { max_weight = std::max(max_weight, q[0]+q[1]+q[2]+q[3]); }
+		test(best_quadrangles[0].weight == double(max_weight));
+	}
+	// all intersection kernels enumerate the same triangles, also on graphs with nodes of high degree
+	{
+		std::mt19937 gen(7);
+		std::uniform_int_distribution<std::size_t> node(0,999);
+		std::vector<std::array<std::size_t,2>> hub_edges;
+		for(std::size_t c=0; c<5000; ++c) {
+			// every fourth edge is incident to one of the hubs 0,...,4
+			const std::size_t i = c%4 == 0 ? c%5 : node(gen);
+			const std::size_t j = node(gen);
+			if(i != j) { hub_edges.push_back({std::min(i,j), std::max(i,j)}); }
+		}
+		std::sort(hub_edges.begin(), hub_edges.end());
+		hub_edges.erase(std::unique(hub_edges.begin(), hub_edges.end()), hub_edges.end());
+		graph<empty> hg(hub_edges.begin(), hub_edges.end());
+		test(hg.no_edges(0) >= 128);
+
+		auto enumerate = [&](const triangle_intersection_kernel kernel) {
+			std::vector<std::array<std::size_t,3>> t;
+			hg.for_each_triangle([&](const std::size_t i, const std::size_t j, const std::size_t k, const auto& ij, const auto& ik, const auto& jk) {
+				test(i < j && j < k);
+				test(ij.tail() == i && ij.head() == j && ik.tail() == i && ik.head() == k && jk.tail() == j && jk.head() == k);
+				t.push_back({i,j,k});
+			}, kernel);
+			std::sort(t.begin(), t.end());
+			return t;
+		};
+		const auto merge_triangles = enumerate(triangle_intersection_kernel::merge);
+		test(merge_triangles.size() > 0);
+		test(std::adjacent_find(merge_triangles.begin(), merge_triangles.end()) == merge_triangles.end());
+		test(merge_triangles == enumerate(triangle_intersection_kernel::galloping));
+		test(merge_triangles == enumerate(triangle_intersection_kernel::bitset));
+		test(merge_triangles == enumerate(triangle_intersection_kernel::adaptive));
+	}
+	// batched separation of cycles with one repulsive edge and attractive edges otherwise
+	{
+		std::mt19937 gen(11);
+		std::uniform_int_distribution<std::size_t> node(0,499);
+		std::vector<std::array<std::size_t,2>> mc_edges;
+		for(std::size_t c=0; c<1500; ++c) {
+			const std::size_t i = node(gen);
+			const std::size_t j = node(gen);
+			if(i != j) { mc_edges.push_back({std::min(i,j), std::max(i,j)}); }
+		}
+		std::sort(mc_edges.begin(), mc_edges.end());
+		mc_edges.erase(std::unique(mc_edges.begin(), mc_edges.end()), mc_edges.end());
+		// every fourth edge is repulsive
+		auto cost = [](const auto& e) { return (e[0]+e[1])%4 == 0 ? -1.0 : 1.0; };
+		graph<double> mg(mc_edges.begin(), mc_edges.end(), cost);
+
+		std::vector<std::array<std::size_t,2>> repulsive_edges;
+		for(const auto& e : mc_edges) { if(cost(e) < 0.0) { repulsive_edges.push_back(e); } }
+		auto attractive = [](const std::size_t i, const std::size_t j, const double c) { return c > 0.0; };
+
+		thread_pool_executor e(4);
+		bfs_separation<graph<double>> separation(mg, e);
+		const auto paths = separation.find_paths(repulsive_edges, attractive);
+		sequential_executor seq_e;
+		bfs_separation<graph<double>> seq_separation(mg, seq_e);
+		test(paths == seq_separation.find_paths(repulsive_edges, attractive));
+
+		bfs_data<graph<double>> bfs(mg);
+		std::size_t no_paths = 0;
+		for(std::size_t q=0; q<repulsive_edges.size(); ++q) {
+			const auto& p = paths[q];
+			const auto single_path = bfs.find_path(repulsive_edges[q][0], repulsive_edges[q][1], attractive, bfs_data<graph<double>>::no_edge_op);
+			test(p.size() == single_path.size());
+			if(p.empty()) { continue; }
+			++no_paths;
+			test(p.front() == repulsive_edges[q][0] && p.back() == repulsive_edges[q][1]);
+			for(std::size_t c=0; c+1<p.size(); ++c) {
+				test(mg.edge(p[c], p[c+1]) > 0.0);
+			}
+		}
+		test(no_paths > 0 && no_paths < repulsive_edges.size());
+
+		const auto cycles = separation.find_cycles(repulsive_edges, attractive);
+		test(cycles.size() == no_paths);
+		for(std::size_t c=1; c<cycles.size(); ++c) { test(cycles[c-1].size() <= cycles[c].size()); }
+	}
 }
@@ -0,0 +1,77 @@
+#include "test.h"
+#include "locality_ordering.hxx"
+#include "two_dimensional_variable_array.hxx"
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <array>
+
+using namespace LP_MP;
+
+two_dim_variable_array<INDEX> adjacency_from_edges(const INDEX n, const std::vector<std::array<INDEX,2>>& edges)
+{
+   std::vector<INDEX> degree(n, 0);
+   for(const auto& e : edges) { ++degree[e[0]]; ++degree[e[1]]; }
+   two_dim_variable_array<INDEX> adjacency(degree);
+   std::fill(degree.begin(), degree.end(), 0);
+   for(const auto& e : edges) {
+      adjacency(e[0], degree[e[0]]++) = e[1];
+      adjacency(e[1], degree[e[1]]++) = e[0];
+   }
+   return adjacency;
+}
+
+bool is_permutation(std::vector<INDEX> order, const INDEX n)
+{
+   std::sort(order.begin(), order.end());
+   std::vector<INDEX> identity(n);
+   std::iota(identity.begin(), identity.end(), 0);
+   return order == identity;
+}
+
+int main(int argc, char** argv)
+{
+   // grid with randomly permuted node numbers: ordering recovers bandwidth of the side length
+   {
+      const INDEX size = 30;
+      const INDEX n = size*size;
+      std::vector<INDEX> label(n);
+      std::iota(label.begin(), label.end(), 0);
+      std::mt19937 gen(0);
+      std::shuffle(label.begin(), label.end(), gen);
+      std::vector<std::array<INDEX,2>> edges;
+      for(INDEX x=0; x<size; ++x) {
+         for(INDEX y=0; y<size; ++y) {
+            if(x+1 < size) { edges.push_back({label[x*size + y], label[(x+1)*size + y]}); }
+            if(y+1 < size) { edges.push_back({label[x*size + y], label[x*size + y+1]}); }
+         }
+      }
+      const auto adjacency = adjacency_from_edges(n, edges);
+      std::vector<INDEX> identity(n);
+      std::iota(identity.begin(), identity.end(), 0);
+
+      const auto order = reverse_cuthill_mckee(adjacency);
+      test(is_permutation(order, n));
+      test(ordering_bandwidth(adjacency, order) <= 2*size);
+      test(ordering_bandwidth(adjacency, order) < ordering_bandwidth(adjacency, identity));
+   }
+
+   // several components and isolated nodes
+   {
+      const auto adjacency = adjacency_from_edges(7, {{0,3}, {3,5}, {1,6}});
+      const auto order = reverse_cuthill_mckee(adjacency);
+      test(is_permutation(order, 7));
+      test(ordering_bandwidth(adjacency, order) == 1);
+   }
+
+   // path: bandwidth 1
+   {
+      const INDEX n = 100;
+      std::vector<std::array<INDEX,2>> edges;
+      for(INDEX i=0; i+1<n; ++i) { edges.push_back({(7*i)%n, (7*(i+1))%n}); }
+      const auto adjacency = adjacency_from_edges(n, edges);
+      const auto order = reverse_cuthill_mckee(adjacency);
+      test(is_permutation(order, n));
+      test(ordering_bandwidth(adjacency, order) == 1);
+   }
+}
@@ -0,0 +1,70 @@
+#include "test.h"
+#include "numa.hxx"
+#include <thread>
+#include <unistd.h>
+
+using namespace LP_MP;
+
+int main(int argc, char** argv)
+{
+   // threads of mirrored static blocks share a node, nodes are used evenly
+   for(INDEX no_nodes=1; no_nodes<=4; ++no_nodes) {
+      for(INDEX no_threads=1; no_threads<=16; ++no_threads) {
+         std::vector<INDEX> threads_per_node(no_nodes, 0);
+         for(INDEX t=0; t<no_threads; ++t) {
+            const INDEX node = numa_thread_node(t, no_threads, no_nodes);
+            test(node < no_nodes);
+            test(node == numa_thread_node(no_threads-1-t, no_threads, no_nodes));
+            if(t > 0 && t < (no_threads+1)/2) { test(node >= numa_thread_node(t-1, no_threads, no_nodes)); }
+            ++threads_per_node[node];
+         }
+         if(no_threads >= 2*no_nodes) {
+            const auto minmax = std::minmax_element(threads_per_node.begin(), threads_per_node.end());
+            test(*minmax.first > 0);
+            test(*minmax.second - *minmax.first <= 3); // one pair of threads and the unpaired middle thread
+         }
+      }
+   }
+
+   // pages of all dual memory are collected, each page once
+   {
+      const std::uintptr_t page_size = sysconf(_SC_PAGESIZE);
+      vector<REAL> v(3000, 1.0);
+      matrix<REAL> m(100, 30);
+      std::array<REAL,4> a{1.0,2.0,3.0,4.0};
+      std::vector<void*> pages;
+      numa_page_archive ar(pages);
+      ar(v, m, a);
+      numa_move_pages(pages, 0);
+      test(std::is_sorted(pages.begin(), pages.end()));
+      test(std::adjacent_find(pages.begin(), pages.end()) == pages.end());
+      auto page_collected = [&](const void* p) {
+         void* page = reinterpret_cast<void*>(reinterpret_cast<std::uintptr_t>(p) & ~(page_size-1));
+         return std::binary_search(pages.begin(), pages.end(), page);
+      };
+      for(const auto& x : v) { test(page_collected(&x)); }
+      for(INDEX i=0; i<m.dim1(); ++i) {
+         for(INDEX j=0; j<m.dim2(); ++j) { test(page_collected(&m(i,j))); }
+      }
+      test(page_collected(a.data()) && page_collected(a.data() + 3));
+      test(pages.size() <= (sizeof(REAL)*(v.size() + m.dim1()*m.padded_dim2()))/page_size + 3 + 2);
+   }
+
+   // vectors allocated from the arena of one node can be freed on a thread of another node
+   if(no_stack_allocators > 1) {
+      numa_arenas_active = true;
+      std::vector<vector<REAL>> vectors;
+      vectors.reserve(100);
+      std::thread t([&]() {
+         stack_allocator_index = 1;
+         for(INDEX i=0; i<100; ++i) { vectors.emplace_back(10, REAL(i)); }
+      });
+      t.join();
+      test(stack_allocator_index == 0);
+      for(auto& v : vectors) {
+         test(&owning_real_block_arena(v.begin()) == &global_real_block_arena_array[1]);
+      }
+      vectors.clear();
+      numa_arenas_active = false;
+   }
+}
@@ -0,0 +1,51 @@
+#include "test.h"
+#include "priority_schedule.hxx"
+#include <random>
+#include <algorithm>
+
+using namespace LP_MP;
+
+int main(int argc, char** argv)
+{
+   // elements come out by decreasing priority, ties by increasing index
+   {
+      indexed_priority_queue q;
+      q.init(5, 1.0, 0.0);
+      q.set(3, 2.0);
+      q.set(1, 0.5);
+      q.set(4, 0.0); // not above threshold, removed
+      test(q.size() == 4);
+      test(!q.contains(4) && q.priority(4) == 0.0);
+      std::vector<std::size_t> order;
+      while(!q.empty()) { order.push_back(q.top()); q.pop(); }
+      test(order == std::vector<std::size_t>({3,0,2,1}));
+   }
+
+   // random priority changes against a sorted reference
+   {
+      std::mt19937 gen(0);
+      std::uniform_real_distribution<REAL> dist(-1.0, 1.0);
+      const std::size_t n = 1000;
+      const REAL threshold = 0.1;
+      indexed_priority_queue q;
+      q.init(n, 0.0, threshold);
+      test(q.empty());
+      std::vector<REAL> p(n, 0.0);
+      for(std::size_t k=0; k<10*n; ++k) {
+         const std::size_t i = gen() % n;
+         p[i] = dist(gen);
+         q.set(i, p[i]);
+      }
+      std::vector<std::size_t> expected;
+      for(std::size_t i=0; i<n; ++i) {
+         if(p[i] > threshold) { expected.push_back(i); }
+      }
+      std::sort(expected.begin(), expected.end(), [&](auto i, auto j) { return p[i] > p[j] || (p[i] == p[j] && i < j); });
+      test(q.size() == expected.size());
+      for(const std::size_t i : expected) {
+         test(q.top() == i && q.top_priority() == p[i]);
+         q.pop();
+      }
+      test(q.empty());
+   }
+}
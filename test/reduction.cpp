@@ -0,0 +1,53 @@
+#include "test.h"
+#include "reduction.hxx"
+#include <random>
+#include <vector>
+#include <cmath>
+
+using namespace LP_MP;
+
+int main(int argc, char** argv)
+{
+   std::mt19937 gen(0);
+   std::uniform_real_distribution<double> dist(-1e6, 1e6);
+   std::vector<double> x(100003);
+   for(auto& v : x) { v = dist(gen); }
+
+   // result only depends on the input, compare against the same blocking computed by hand
+   const double s = deterministic_sum<double>(x.size(), [&](const std::size_t i) { return x[i]; });
+   std::vector<double> partial;
+   for(std::size_t b=0; b<x.size(); b+=reduction_block_size) {
+      double p = 0.0;
+      for(std::size_t i=b; i<std::min(x.size(), b+reduction_block_size); ++i) { p += x[i]; }
+      partial.push_back(p);
+   }
+   test(s == pairwise_sum(partial, 0, partial.size()));
+   double naive = 0.0;
+   for(const double v : x) { naive += v; }
+   test(std::abs(s - naive) <= 1e-6*std::abs(naive) + 1e-3);
+
+   for(std::size_t t=1; t<=8; ++t) {
+      thread_pool_executor e(t);
+      test(s == deterministic_sum<double>(e, x.size(), [&](const std::size_t i) { return x[i]; }));
+   }
+
+#ifdef LP_MP_PARALLEL
+   for(std::size_t t=1; t<=8; ++t) {
+      openmp_executor e(t);
+      test(s == deterministic_sum<double>(e, x.size(), [&](const std::size_t i) { return x[i]; }));
+   }
+   // inside another parallel region the team is smaller than requested
+   {
+      openmp_executor e(4);
+      std::vector<double> nested_sums(4);
+      e.run(4, [&](const INDEX t) { nested_sums[t] = deterministic_sum<double>(e, x.size(), [&](const std::size_t i) { return x[i]; }); });
+      for(const double n : nested_sums) { test(s == n); }
+   }
+#endif
+
+   test(deterministic_sum<double>(0, [&](const std::size_t i) { return x[i]; }) == 0.0);
+
+   test(parallel_all_of(x.size(), [&](const std::size_t i) { return std::abs(x[i]) <= 1e6; }));
+   test(!parallel_all_of(x.size(), [&](const std::size_t i) { return i != 77777; }));
+   test(parallel_all_of(0, [&](const std::size_t i) { return false; }));
+}
@@ -0,0 +1,85 @@
+#include "test.h"
+#include "spinlock.hxx"
+#include <thread>
+#include <vector>
+#include <mutex>
+
+using namespace LP_MP;
+
+// concurrent increments under the lock must not get lost
+template<typename LOCK>
+void test_mutual_exclusion()
+{
+   LOCK l;
+   std::size_t counter = 0;
+   const std::size_t no_threads = 4;
+   const std::size_t no_increments = 100000;
+   std::vector<std::thread> threads;
+   for(std::size_t t=0; t<no_threads; ++t) {
+      threads.emplace_back([&]() {
+            for(std::size_t i=0; i<no_increments; ++i) {
+               std::lock_guard<LOCK> lock(l);
+               ++counter;
+            }
+         });
+   }
+   for(auto& t : threads) { t.join(); }
+   test(counter == no_threads*no_increments);
+}
+
+int main(int argc, char** argv)
+{
+   test_mutual_exclusion<recursive_spinlock>();
+
+   // reentrancy: the owner may lock again, other threads may not
+   {
+      recursive_spinlock l;
+      test(l.try_lock());
+      test(l.try_lock());
+      bool other_locked = true;
+      std::thread([&]() { other_locked = l.try_lock(); }).join();
+      test(!other_locked);
+      l.unlock();
+      std::thread([&]() { other_locked = l.try_lock(); }).join();
+      test(!other_locked);
+      l.unlock();
+      std::thread([&]() { other_locked = l.try_lock(); if(other_locked) { l.unlock(); } }).join();
+      test(other_locked);
+   }
+
+   // recursion deeper than the 12 bit depth counter is rejected, the lock stays usable
+   {
+      recursive_spinlock l;
+      const std::size_t max_depth = (1u << 12) - 1;
+      for(std::size_t i=0; i<max_depth; ++i) { test(l.try_lock()); }
+      bool overflow_detected = false;
+      try { l.try_lock(); } catch(std::runtime_error&) { overflow_detected = true; }
+      test(overflow_detected);
+      for(std::size_t i=0; i<max_depth; ++i) { l.unlock(); }
+      bool other_locked = false;
+      std::thread([&]() { other_locked = l.try_lock(); if(other_locked) { l.unlock(); } }).join();
+      test(other_locked);
+   }
+
+   // tags are unique among live threads: a tag is only reused after its thread has exited, and the pool throws instead of wrapping around
+   {
+      thread_tag_pool pool(3);
+      const std::uint32_t t1 = pool.acquire();
+      const std::uint32_t t2 = pool.acquire();
+      const std::uint32_t t3 = pool.acquire();
+      test(t1 != t2 && t1 != t3 && t2 != t3);
+      bool exhausted = false;
+      try { pool.acquire(); } catch(std::runtime_error&) { exhausted = true; }
+      test(exhausted);
+      pool.release(t2);
+      test(pool.acquire() == t2);
+   }
+   {
+      const std::uint32_t main_tag = spinlock_thread_tag();
+      std::uint32_t first_tag = 0, second_tag = 0;
+      std::thread([&]() { first_tag = spinlock_thread_tag(); }).join();
+      std::thread([&]() { second_tag = spinlock_thread_tag(); }).join();
+      test(first_tag != main_tag && second_tag != main_tag);
+      test(first_tag == second_tag);
+   }
+}
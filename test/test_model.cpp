@@ -5,6 +5,7 @@
 #include "test.h"
 #include "LP_external_interface.hxx"
 #include "test_model.hxx"
+#include "batch_solver.hxx"
 #include <random>
 
 using namespace LP_MP; 
@@ -47,6 +48,345 @@ int main()
         s.GetLP().get_external_solver().write_to_file("test_problem.lp");
     }
 
+    { // checkpoint round trip
+        TCLAP::CmdLine cmd("test checkpoint");
+        LP<test_FMC> lp1(cmd);
+        auto* f1 = lp1.template add_factor<typename test_FMC::factor>(0,1);
+        auto* f2 = lp1.template add_factor<typename test_FMC::factor>(1,0);
+        lp1.template add_message<typename test_FMC::message>(f1,f2);
+        {
+            dual_checkpoint c("test_checkpoint.lpmp");
+            c.save(lp1, 7);
+            c.wait();
+            test(c.exists());
+        }
+
+        TCLAP::CmdLine cmd2("test checkpoint");
+        LP<test_FMC> lp2(cmd2);
+        auto* g1 = lp2.template add_factor<typename test_FMC::factor>(2,2);
+        auto* g2 = lp2.template add_factor<typename test_FMC::factor>(3,3);
+        lp2.template add_message<typename test_FMC::message>(g1,g2);
+        dual_checkpoint c("test_checkpoint.lpmp");
+        test(c.load(lp2) == 7);
+        test(lp2.LowerBound() == lp1.LowerBound());
+    }
+
+    { // binary model file round trip
+        TCLAP::CmdLine cmd("test model file");
+        LP<test_FMC_two_types> lp1(cmd);
+        auto* f1 = lp1.template add_factor<typename test_FMC_two_types::factor_a>(0,1);
+        auto* f2 = lp1.template add_factor<typename test_FMC_two_types::factor_b>(1,0);
+        auto* f3 = lp1.template add_factor<typename test_FMC_two_types::factor_a>(0,0);
+        lp1.template add_message<typename test_FMC_two_types::message_ab>(f1,f2);
+        lp1.template add_message<typename test_FMC_two_types::message_ba>(f2,f3);
+        lp1.AddFactorRelation(f1,f2);
+        lp1.add_to_constant(2.0);
+        lp1.save_model("test_model.lpmp");
+
+        // the problem is rebuilt from the file alone
+        TCLAP::CmdLine cmd2("test model file");
+        LP<test_FMC_two_types> lp2(cmd2);
+        lp2.load_model("test_model.lpmp");
+        test(lp2.GetNumberOfFactors() == 3);
+        test(lp2.GetNumberOfMessages() == 2);
+        test(lp2.factor_types() == lp1.factor_types());
+        for(INDEX i=0; i<lp1.GetNumberOfMessages(); ++i) {
+            test(lp2.GetMessage(i).left == lp2.GetFactor(i) && lp2.GetMessage(i).right == lp2.GetFactor(i+1));
+        }
+        test(lp2.LowerBound() == lp1.LowerBound());
+        test(lp2.forward_update_ordering().size() == lp1.forward_update_ordering().size());
+        lp1.Begin();
+        lp2.Begin();
+        lp1.set_reparametrization(LPReparametrizationMode::Anisotropic);
+        lp2.set_reparametrization(LPReparametrizationMode::Anisotropic);
+        for(INDEX iter=0; iter<10; ++iter) {
+            lp1.ComputePass(iter);
+            lp2.ComputePass(iter);
+        }
+        test(lp2.LowerBound() == lp1.LowerBound());
+        test(std::abs(lp2.LowerBound() - 3.0) <= eps);
+
+        // a model file of another problem type or into a non-empty problem is rejected
+        TCLAP::CmdLine cmd3("test model file");
+        LP<test_FMC> lp3(cmd3);
+        bool mismatch_detected = false;
+        try { lp3.load_model("test_model.lpmp"); } catch(std::runtime_error&) { mismatch_detected = true; }
+        test(mismatch_detected);
+        bool non_empty_detected = false;
+        try { lp2.load_model("test_model.lpmp"); } catch(std::runtime_error&) { non_empty_detected = true; }
+        test(non_empty_detected);
+    }
+
+    { // priority scheduling of factor updates
+        TCLAP::CmdLine cmd("test priority");
+        LP<test_FMC> lp(cmd);
+        std::vector<std::string> args({{"test priority"}, {"--reparametrizationType"}, {"priority"}});
+        cmd.parse(args);
+        auto* f1 = lp.template add_factor<typename test_FMC::factor>(0,1);
+        auto* f2 = lp.template add_factor<typename test_FMC::factor>(1,0);
+        auto* f3 = lp.template add_factor<typename test_FMC::factor>(0,0);
+        lp.template add_message<typename test_FMC::message>(f1,f2);
+        lp.template add_message<typename test_FMC::message>(f1,f3);
+        lp.Begin();
+        lp.set_reparametrization(LPReparametrizationMode::Anisotropic);
+        for(INDEX iter=0; iter<10; ++iter) {
+            lp.ComputePass(iter);
+        }
+        test(std::abs(lp.LowerBound() - 1.0) <= eps);
+        // plain passes, as used by rounding, send messages like shared reparametrization
+        lp.ComputeForwardPass();
+        lp.ComputeBackwardPass();
+        test(std::abs(lp.LowerBound() - 1.0) <= eps);
+    }
+
+    { // converged factors are skipped
+        TCLAP::CmdLine cmd("test skipping");
+        LP<test_FMC> lp(cmd);
+        std::vector<std::string> args({{"test skipping"}, {"--skipConvergedFactors"}});
+        cmd.parse(args);
+        auto* f1 = lp.template add_factor<typename test_FMC::factor>(0,1);
+        auto* f2 = lp.template add_factor<typename test_FMC::factor>(1,0);
+        auto* f3 = lp.template add_factor<typename test_FMC::factor>(0,0);
+        lp.template add_message<typename test_FMC::message>(f1,f2);
+        lp.template add_message<typename test_FMC::message>(f1,f3);
+        lp.Begin();
+        lp.set_reparametrization(LPReparametrizationMode::Anisotropic);
+        for(INDEX iter=0; iter<10; ++iter) {
+            lp.ComputePass(iter);
+        }
+        test(std::abs(lp.LowerBound() - 1.0) <= eps);
+        test(lp.update_statistics().skipped > 0);
+    }
+
+    { // batched passes reach the same lower bound as passes in update order
+        // chain a - b - a - b - ... of alternating factor types, the optimum takes the same label in all factors
+        auto build = [](LP<test_FMC_two_types>& lp) {
+            FactorTypeAdapter* prev = nullptr;
+            for(INDEX i=0; i<8; ++i) {
+                const REAL x = REAL((3*i)%5);
+                const REAL y = REAL((2*i+1)%4);
+                if(i%2 == 0) {
+                    auto* f = lp.template add_factor<typename test_FMC_two_types::factor_a>(x,y);
+                    if(prev != nullptr) { lp.template add_message<typename test_FMC_two_types::message_ba>(static_cast<typename test_FMC_two_types::factor_b*>(prev), f); }
+                    prev = f;
+                } else {
+                    auto* f = lp.template add_factor<typename test_FMC_two_types::factor_b>(x,y);
+                    lp.template add_message<typename test_FMC_two_types::message_ab>(static_cast<typename test_FMC_two_types::factor_a*>(prev), f);
+                    prev = f;
+                }
+            }
+        };
+        std::array<REAL,2> optimum = {0.0, 0.0};
+        for(INDEX i=0; i<8; ++i) { optimum[0] += REAL((3*i)%5); optimum[1] += REAL((2*i+1)%4); }
+
+        std::vector<REAL> bounds;
+        for(const bool batched : {false, true}) {
+            TCLAP::CmdLine cmd("test batched");
+            LP<test_FMC_two_types> lp(cmd);
+            std::vector<std::string> args({{"test batched"}});
+            if(batched) { args.push_back("--batchedFactorUpdate"); }
+            cmd.parse(args);
+            build(lp);
+            lp.Begin();
+            lp.set_reparametrization(LPReparametrizationMode::Anisotropic);
+            REAL prev_lb = lp.LowerBound();
+            for(INDEX iter=0; iter<50; ++iter) {
+                lp.ComputePass(iter);
+                const REAL lb = lp.LowerBound();
+                test(lb >= prev_lb - eps);
+                prev_lb = lb;
+            }
+            test(std::abs(prev_lb - std::min(optimum[0], optimum[1])) <= eps);
+            bounds.push_back(prev_lb);
+        }
+        test(std::abs(bounds[0] - bounds[1]) <= eps);
+    }
+
+    { // cached lower bounds agree with recomputation, converged factors are not recomputed
+        for(const bool skip : {false, true}) {
+            TCLAP::CmdLine cmd("test incremental lower bound");
+            LP<test_FMC> lp(cmd);
+            std::vector<std::string> args({{"test incremental lower bound"}, {"--incrementalLowerBound"}});
+            if(skip) { args.push_back("--skipConvergedFactors"); }
+            cmd.parse(args);
+            auto* f1 = lp.template add_factor<typename test_FMC::factor>(0,1);
+            auto* f2 = lp.template add_factor<typename test_FMC::factor>(1,0);
+            auto* f3 = lp.template add_factor<typename test_FMC::factor>(0,0);
+            lp.template add_message<typename test_FMC::message>(f1,f2);
+            lp.template add_message<typename test_FMC::message>(f1,f3);
+            lp.Begin();
+            lp.set_reparametrization(LPReparametrizationMode::Anisotropic);
+            test(lp.LowerBound() == f1->LowerBound() + f2->LowerBound() + f3->LowerBound());
+            for(INDEX iter=0; iter<10; ++iter) {
+                lp.ComputePass(iter);
+                test(std::abs(lp.LowerBound() - (f1->LowerBound() + f2->LowerBound() + f3->LowerBound())) <= eps);
+            }
+            test(std::abs(lp.LowerBound() - 1.0) <= eps);
+
+            const auto statistics = lp.update_statistics();
+            lp.ComputePass(10);
+            lp.LowerBound();
+            const std::size_t recomputed = lp.update_statistics().lower_bounds_recomputed - statistics.lower_bounds_recomputed;
+            if(skip) {
+                test(recomputed == 0);
+            } else {
+                // every updated factor is recomputed after a plain pass
+                test(recomputed == 3);
+            }
+
+            lp.update_potentials(f2, [](auto& f) { f.cost[0] += 1.0; });
+            test(std::abs(lp.LowerBound() - (f1->LowerBound() + f2->LowerBound() + f3->LowerBound())) <= eps);
+        }
+    }
+
+    { // relocating dual memory keeps potentials
+        for(const std::string order : {"update", "rcm"}) {
+            TCLAP::CmdLine cmd("test relocation");
+            LP<test_FMC> lp(cmd);
+            std::vector<std::string> args({{"test relocation"}, {"--relocateFactors"}, order});
+            cmd.parse(args);
+            auto* f1 = lp.template add_factor<typename test_FMC::factor>(0,1);
+            auto* f2 = lp.template add_factor<typename test_FMC::factor>(1,0);
+            auto* f3 = lp.template add_factor<typename test_FMC::factor>(0,0);
+            lp.template add_message<typename test_FMC::message>(f1,f2);
+            lp.template add_message<typename test_FMC::message>(f1,f3);
+            const auto* cost = f1->GetFactor()->cost.begin();
+            lp.Begin();
+            test(f1->GetFactor()->cost.begin() != cost);
+            test(f1->GetFactor()->cost[0] == 0.0 && f1->GetFactor()->cost[1] == 1.0);
+            lp.set_reparametrization(LPReparametrizationMode::Anisotropic);
+            for(INDEX iter=0; iter<10; ++iter) {
+                lp.ComputePass(iter);
+            }
+            test(std::abs(lp.LowerBound() - 1.0) <= eps);
+        }
+    }
+
+    { // copies of an LP are optimized independently
+        TCLAP::CmdLine cmd("test copy");
+        LP<test_FMC> lp(cmd);
+        auto* f1 = lp.template add_factor<typename test_FMC::factor>(0,1);
+        auto* f2 = lp.template add_factor<typename test_FMC::factor>(1,0);
+        auto* f3 = lp.template add_factor<typename test_FMC::factor>(0,0);
+        lp.template add_message<typename test_FMC::message>(f1,f2);
+        lp.template add_message<typename test_FMC::message>(f1,f3);
+        LP<test_FMC> copy(lp);
+        test(copy.GetNumberOfFactors() == 3);
+        test(copy.GetNumberOfMessages() == 2);
+        test(copy.GetFactor(0) != lp.GetFactor(0));
+        copy.Begin();
+        copy.set_reparametrization(LPReparametrizationMode::Anisotropic);
+        for(INDEX iter=0; iter<10; ++iter) {
+            copy.ComputePass(iter);
+        }
+        test(std::abs(copy.LowerBound() - 1.0) <= eps);
+        test(lp.LowerBound() == 0.0);
+    }
+
+    { // primal rounding in a background thread
+        AsyncMpRoundingSolver<Solver<LP<test_FMC>, StandardVisitor>> s(std::vector<std::string>{{"test async rounding"}, {"--maxIter"}, {"20"}, {"--primalComputationInterval"}, {"2"}});
+        auto& lp = s.GetLP();
+        auto* f1 = lp.template add_factor<typename test_FMC::factor>(0,1);
+        auto* f2 = lp.template add_factor<typename test_FMC::factor>(1,0);
+        auto* f3 = lp.template add_factor<typename test_FMC::factor>(0,0);
+        lp.template add_message<typename test_FMC::message>(f1,f2);
+        lp.template add_message<typename test_FMC::message>(f1,f3);
+        s.Solve();
+        test(std::abs(s.lower_bound() - 1.0) <= eps);
+        test(std::abs(s.primal_cost() - 1.0) <= eps);
+    }
+
+    { // resuming from a checkpoint continues the iteration count of the visitor
+        std::remove("test_resume.lpmp");
+        auto solve = [](const INDEX max_iter, const bool resume) {
+            std::vector<std::string> options({{"test resume"}, {"--maxIter"}, {std::to_string(max_iter)}, {"--checkpoint"}, {"test_resume.lpmp"}, {"--checkpointInterval"}, {"5"}});
+            if(resume) { options.push_back("--resume"); }
+            Solver<LP<test_FMC>, StandardVisitor> s(options);
+            auto& lp = s.GetLP();
+            auto* f1 = lp.template add_factor<typename test_FMC::factor>(0,1);
+            auto* f2 = lp.template add_factor<typename test_FMC::factor>(1,0);
+            lp.template add_message<typename test_FMC::message>(f1,f2);
+            s.Solve();
+        };
+        solve(7, false);
+        // resumed in iteration 5, hence 7 more iterations until iteration 12 and the last checkpoint is taken in iteration 10
+        solve(12, true);
+        TCLAP::CmdLine cmd("test resume");
+        LP<test_FMC> lp(cmd);
+        auto* f1 = lp.template add_factor<typename test_FMC::factor>(0,1);
+        auto* f2 = lp.template add_factor<typename test_FMC::factor>(1,0);
+        lp.template add_message<typename test_FMC::message>(f1,f2);
+        dual_checkpoint c("test_resume.lpmp");
+        test(c.load(lp) == 10);
+    }
+
+    { // warm start after potential updates
+        for(const std::string type : {"skip", "priority"}) {
+            TCLAP::CmdLine cmd("test warm start");
+            LP<test_FMC> lp(cmd);
+            std::vector<std::string> args({{"test warm start"}});
+            if(type == "skip") {
+                args.push_back("--skipConvergedFactors");
+            } else {
+                args.insert(args.end(), {{"--reparametrizationType"}, {"priority"}});
+            }
+            cmd.parse(args);
+            // two independent components, only the first one is changed
+            auto* f1 = lp.template add_factor<typename test_FMC::factor>(0,1);
+            auto* f2 = lp.template add_factor<typename test_FMC::factor>(1,0);
+            auto* f3 = lp.template add_factor<typename test_FMC::factor>(0,2);
+            auto* f4 = lp.template add_factor<typename test_FMC::factor>(2,0);
+            lp.template add_message<typename test_FMC::message>(f1,f2);
+            lp.template add_message<typename test_FMC::message>(f3,f4);
+            lp.Begin();
+            lp.set_reparametrization(LPReparametrizationMode::Anisotropic);
+            for(INDEX iter=0; iter<10; ++iter) {
+                lp.ComputePass(iter);
+            }
+            test(std::abs(lp.LowerBound() - 3.0) <= eps);
+
+            // label 1 of the first component becomes cheaper by 1
+            lp.update_potentials(f1, [](auto& f) { f.cost[1] -= 1.0; });
+            const auto statistics = lp.update_statistics();
+            for(INDEX iter=10; iter<20; ++iter) {
+                lp.ComputePass(iter);
+            }
+            test(std::abs(lp.LowerBound() - 2.0) <= eps);
+            if(type == "skip") {
+                // the unchanged component is not updated again
+                test(lp.update_statistics().skipped - statistics.skipped >= 10);
+            }
+        }
+    }
+
+    { // batch solving of instances differing in potentials
+        auto build = [](LP<test_FMC>& lp) {
+            auto* f1 = lp.template add_factor<typename test_FMC::factor>(0,1);
+            auto* f2 = lp.template add_factor<typename test_FMC::factor>(1,0);
+            auto* f3 = lp.template add_factor<typename test_FMC::factor>(0,0);
+            lp.template add_message<typename test_FMC::message>(f1,f2);
+            lp.template add_message<typename test_FMC::message>(f1,f3);
+        };
+        thread_pool_executor e(3);
+        batch_solver<test_FMC> b(build, {{"test batch"}, {"--maxIter"}, {"10"}, {"--primalRounding"}}, e);
+        test(b.no_workers() == 3);
+        const INDEX no_instances = 20;
+        auto set_potentials = [](LP<test_FMC>& lp, const INDEX i) {
+            auto* f1 = dynamic_cast<typename test_FMC::factor*>(lp.GetFactor(0));
+            test(f1->GetFactor()->cost[0] == 0.0 && f1->GetFactor()->cost[1] == 1.0);
+            f1->GetFactor()->cost[1] = REAL(i)/8.0;
+        };
+        // optimum is attained by label 1 in all factors if its cost is below the cost 1 of label 0
+        const auto results = b.solve(no_instances, set_potentials);
+        test(results.size() == no_instances);
+        for(INDEX i=0; i<no_instances; ++i) {
+            test(std::abs(results[i].lower_bound - std::min(REAL(1.0), REAL(i)/8.0)) <= eps);
+            // the rounding pass of the LP leaves the primal of the sending factor f1 unset in this model, hence only weak duality can be checked
+            test(results[i].primal_cost >= results[i].lower_bound - eps);
+            test(results[i].iterations == 10);
+        }
+    }
+
    {
        //Solver<LP<test_FMC>, StandardVisitor> s;
        //auto& lp = s.GetLP();
@@ -8,6 +8,7 @@
 
 namespace LP_MP {
 struct test_factor {
+  test_factor() : test_factor(0.0, 0.0) {}
   test_factor(const REAL x, const REAL y)
     : cost(2)
   {
@@ -136,6 +137,18 @@ struct test_FMC { // factor message connection
   using ProblemDecompositionList = meta::list<>;
 };
 
+// same factors and messages as test_FMC, with two factor types, for passes that depend on factor types
+struct test_FMC_two_types {
+  constexpr static const char* name = "test model with two factor types";
+  using factor_a = FactorContainer<test_factor, test_FMC_two_types, 0>;
+  using factor_b = FactorContainer<test_factor, test_FMC_two_types, 1>;
+  using message_ab = MessageContainer<test_message, 0, 1, message_passing_schedule::left, variableMessageNumber, variableMessageNumber, test_FMC_two_types, 0>;
+  using message_ba = MessageContainer<test_message, 1, 0, message_passing_schedule::left, variableMessageNumber, variableMessageNumber, test_FMC_two_types, 1>;
+  using FactorList = meta::list<factor_a, factor_b>;
+  using MessageList = meta::list<message_ab, message_ba>;
+  using ProblemDecompositionList = meta::list<>;
+};
+
 template<typename LP_TYPE>
 void build_test_model(LP_TYPE& lp)
 {
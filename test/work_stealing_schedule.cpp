@@ -0,0 +1,49 @@
+#include "test.h"
+#include "work_stealing_schedule.hxx"
+#include <thread>
+#include <atomic>
+
+using namespace LP_MP;
+
+// every index must be processed exactly once, also when threads have unbalanced work
+void test_work_stealing_schedule(const std::size_t n, const std::size_t no_threads, const std::size_t chunk_size, const bool steal)
+{
+   work_stealing_schedule schedule;
+   std::vector<std::atomic<int>> visits(n);
+   for(auto& v : visits) { v = 0; }
+
+   for(std::size_t pass=0; pass<3; ++pass) {
+      schedule.init(n, no_threads, chunk_size);
+      std::vector<std::thread> threads;
+      for(std::size_t t=0; t<no_threads; ++t) {
+         threads.emplace_back([&,t]() {
+               schedule.run(t, [&](const std::size_t begin, const std::size_t end) {
+                     for(std::size_t i=begin; i<end; ++i) { ++visits[i]; }
+                     if(t == 0) { std::this_thread::sleep_for(std::chrono::microseconds(50)); }
+                     }, steal);
+               });
+      }
+      for(auto& t : threads) { t.join(); }
+      schedule.finish();
+   }
+
+   for(auto& v : visits) { test(v == 3); }
+   test(schedule.statistics().size() == no_threads);
+   std::size_t chunks = 0;
+   for(const auto& stat : schedule.statistics()) {
+      chunks += stat.chunks_processed;
+      test(stat.busy_time >= 0.0 && stat.idle_time >= 0.0);
+      if(!steal) { test(stat.chunks_stolen == 0); }
+   }
+   test(chunks == 3*((n + chunk_size - 1)/chunk_size));
+}
+
+int main(int argc, char** argv)
+{
+   test_work_stealing_schedule(0, 4, 8, true);
+   test_work_stealing_schedule(1, 4, 8, true);
+   test_work_stealing_schedule(1000, 1, 7, true);
+   test_work_stealing_schedule(1000, 4, 7, true);
+   test_work_stealing_schedule(1000, 4, 7, false);
+   test_work_stealing_schedule(10007, 8, 64, true);
+}